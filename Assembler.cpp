@@ -0,0 +1,1164 @@
+#include "Assembler.hpp"
+#include "FlowAnalysis.hpp"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+#include <sstream>
+#include <cctype>
+#include <charconv>
+
+using namespace std;
+
+// ============================================================================
+// CONSTANTES E TIPOS
+// ============================================================================
+
+enum TokenType {
+    INVALID = 0,
+    ADD = 1,
+    SUB = 2,
+    MULT = 3,
+    DIV = 4,
+    JMP = 5,
+    JMPN = 6,
+    JMPP = 7,
+    JMPZ = 8,
+    COPY = 9,
+    LOAD = 10,
+    STORE = 11,
+    INPUT = 12,
+    OUTPUT = 13,
+    STOP = 14,
+    SPACE = 15,
+    CONST = 16,
+    PLUS = 17,
+    EXTERN = 18,
+    PUBLIC = 19,
+    LABEL = 20,
+    NUMBER = 30
+};
+
+const vector<string> RESERVED_WORDS = {
+    "",      "ADD",   "SUB",   "MULT",  "DIV",
+    "JMP",   "JMPN",  "JMPP",  "JMPZ",  "COPY",
+    "LOAD",  "STORE", "INPUT", "OUTPUT","STOP",
+    "SPACE", "CONST", "+",     "EXTERN","PUBLIC"
+};
+
+const vector<vector<int>> SYNTAX_RULES = {
+    {ADD, LABEL},           {SUB, LABEL},         {MULT, LABEL},
+    {DIV, LABEL},           {JMP, LABEL},         {JMPN, LABEL},
+    {JMPP, LABEL},          {JMPZ, LABEL},        {COPY, LABEL, LABEL},
+    {LOAD, LABEL},          {STORE, LABEL},       {INPUT, LABEL},
+    {OUTPUT, LABEL},        {STOP},               {CONST, NUMBER},
+    {LABEL},                {LABEL, SPACE},       {LABEL, SPACE, NUMBER},
+    {LABEL, ADD, LABEL},    {LABEL, SUB, LABEL},  {LABEL, MULT, LABEL},
+    {LABEL, DIV, LABEL},    {LABEL, JMP, LABEL},  {LABEL, JMPN, LABEL},
+    {LABEL, JMPP, LABEL},   {LABEL, JMPZ, LABEL}, {LABEL, COPY, LABEL, LABEL},
+    {LABEL, LOAD, LABEL},   {LABEL, STORE, LABEL},{LABEL, INPUT, LABEL},
+    {LABEL, OUTPUT, LABEL}, {LABEL, STOP},        {LABEL, CONST, NUMBER},
+    // Suporte para aritmética de endereços (LABEL + NUMBER)
+    {ADD, LABEL, PLUS, NUMBER},     {SUB, LABEL, PLUS, NUMBER},
+    {MULT, LABEL, PLUS, NUMBER},    {DIV, LABEL, PLUS, NUMBER},
+    {JMP, LABEL, PLUS, NUMBER},     {JMPN, LABEL, PLUS, NUMBER},
+    {JMPP, LABEL, PLUS, NUMBER},    {JMPZ, LABEL, PLUS, NUMBER},
+    {LOAD, LABEL, PLUS, NUMBER},    {STORE, LABEL, PLUS, NUMBER},
+    {INPUT, LABEL, PLUS, NUMBER},   {OUTPUT, LABEL, PLUS, NUMBER},
+    {LABEL, ADD, LABEL, PLUS, NUMBER},    {LABEL, SUB, LABEL, PLUS, NUMBER},
+    {LABEL, MULT, LABEL, PLUS, NUMBER},   {LABEL, DIV, LABEL, PLUS, NUMBER},
+    {LABEL, JMP, LABEL, PLUS, NUMBER},    {LABEL, JMPN, LABEL, PLUS, NUMBER},
+    {LABEL, JMPP, LABEL, PLUS, NUMBER},   {LABEL, JMPZ, LABEL, PLUS, NUMBER},
+    {LABEL, LOAD, LABEL, PLUS, NUMBER},   {LABEL, STORE, LABEL, PLUS, NUMBER},
+    {LABEL, INPUT, LABEL, PLUS, NUMBER},  {LABEL, OUTPUT, LABEL, PLUS, NUMBER},
+    // Módulos: importação e exportação de símbolos
+    {LABEL, EXTERN},        {PUBLIC, LABEL}
+};
+
+const int MAX_ADDRESS = 216;
+
+// Tipo de cada palavra gerada (usado pelas otimizações)
+enum WordKind {
+    WORD_DATA = 0,
+    WORD_OPCODE = 1,
+    WORD_OPERAND = 2,
+    WORD_EXTERNAL = 3   // Operando que referencia símbolo EXTERN (contém só o offset)
+};
+
+// Converte um token numérico (só dígitos); false se o valor não cabe em int
+static bool parseNumber(string_view str, int& value) {
+    const char* end = str.data() + str.size();
+    auto result = from_chars(str.data(), end, value);
+    return result.ec == errc() && result.ptr == end;
+}
+
+// ============================================================================
+// IMPLEMENTAÇÃO DO ASSEMBLER
+// ============================================================================
+
+Assembler::Assembler() 
+    : emitDebugInfo(false), optimizeCode(false), optimizeData(false), keepGoing(false), analyzeFlow(false), log(&cout), symbols(&ownSymbols) {
+    reset();
+}
+
+// Volta ao estado inicial mantendo as opções, para reutilizar a instância
+void Assembler::reset() {
+    currentLine = 1;
+    currentAddress = 0;
+    currentPosition = 0;
+    wordCount = 0;
+    lastToken = 0;
+    pendingOffset = 0;
+    
+    addressList.assign(MAX_ADDRESS, 0);
+    wordKinds.assign(MAX_ADDRESS, WORD_DATA);
+    symbolTable.clear();
+    ownSymbols.clear();
+    pendingReferences.clear();
+    dataBlocks.clear();
+    publicLabels.clear();
+    diagnostics.clear();
+    debugInfo = DebugInfo();
+}
+
+void Assembler::compile(const string& filename) {
+    ifstream file(filename);
+    
+    if (!file.is_open()) {
+        throw runtime_error("Nao foi possivel abrir o arquivo '" + filename + "'");
+    }
+    
+    compile(file);
+    file.close();
+}
+
+void Assembler::compile(istream& input) {
+    string line;
+    while (getline(input, line)) {
+        feedLine(line);
+    }
+    finish();
+}
+
+// Uma linha do .pre; o primeiro erro interrompe a montagem, exceto no modo -k
+void Assembler::feedLine(string_view line) {
+    processLine(line);
+    if (!keepGoing && !diagnostics.empty()) {
+        throw runtime_error("Falha na compilacao: " + diagnostics.front().message);
+    }
+    currentLine++;
+}
+
+// Fim da entrada: verificações e passos sobre o programa completo
+void Assembler::finish() {
+    try {
+        if (keepGoing) {
+            reportUndefinedLabels();
+            if (!diagnostics.empty()) return;
+        }
+        // Dados primeiro: os blocos registrados usam as posições originais
+        if (optimizeData) {
+            optimizeDataSection();
+        }
+        if (optimizeCode) {
+            optimize();
+        }
+        if (wordCount > MAX_ADDRESS) {
+            throw runtime_error("Programa com " + to_string(wordCount) +
+                              " palavras nao cabe na memoria (" + to_string(MAX_ADDRESS) + ")");
+        }
+    } catch (const runtime_error& e) {
+        throw runtime_error("Falha na compilacao: " + string(e.what()));
+    }
+}
+
+// Registra o erro; a linha atual é abandonada e a montagem segue na próxima
+void Assembler::reportError(const string& kind, const string& detail) {
+    diagnostics.push_back({currentLine, kind,
+                           "Erro " + kind + " na linha [" + to_string(currentLine) + "]: " + detail});
+}
+
+// No modo de diagnóstico, rótulos não definidos viram erros com a linha do primeiro uso
+void Assembler::reportUndefinedLabels() {
+    for (const auto& pending : pendingReferences) {
+        if (findSymbol(pending.label) >= 0) continue;
+        int line = pending.lines.empty() ? 0 : pending.lines.front();
+        diagnostics.push_back({line, "Semantico",
+                               "Erro Semantico na linha [" + to_string(line) + "]: rotulo nao definido: " + symbols->str(pending.label)});
+    }
+    stable_sort(diagnostics.begin(), diagnostics.end(),
+                [](const Diagnostic& a, const Diagnostic& b) { return a.line < b.line; });
+}
+
+void Assembler::processLine(string_view line) {
+    vector<string_view> tokens = tokenizeLine(line);
+    if (tokens.empty()) return;
+    
+    if (processDirective(tokens)) return;
+    
+    pendingOffset = 0;  // Reset offset no início de cada linha
+    int startAddress = currentAddress;
+    int startPosition = currentPosition;
+    int startWordCount = wordCount;
+    size_t startSymbols = symbolTable.size();
+    size_t startPending = pendingReferences.size();
+    vector<int> tokenTypes = analyzeTokens(tokens);
+    if (tokenTypes.back() == INVALID) {
+        // Erro já registrado
+        discardLine(startAddress, startPosition, startWordCount, startSymbols, startPending);
+        return;
+    }
+    
+    if (!isSyntaxValid(tokenTypes)) {
+        reportError("Sintatico", string(line));
+        discardLine(startAddress, startPosition, startWordCount, startSymbols, startPending);
+        return;
+    }
+    
+    if (emitDebugInfo && currentAddress > startAddress) {
+        debugInfo.addresses.push_back(startAddress);
+        debugInfo.preLines.push_back(currentLine);
+    }
+    
+    if (optimizeData && currentPosition > startPosition) {
+        bool isConst = find(tokenTypes.begin(), tokenTypes.end(), CONST) != tokenTypes.end();
+        bool isSpace = find(tokenTypes.begin(), tokenTypes.end(), SPACE) != tokenTypes.end();
+        if (isConst || isSpace) {
+            dataBlocks.push_back({startPosition, currentPosition - startPosition, isConst});
+        }
+    }
+    
+    pendingOffset = 0;  // Reset offset no final de cada linha também
+}
+
+// Linha rejeitada: os tokens já analisados emitiram palavras e podem ter
+// definido o rótulo ou criado pendências. Tudo é desfeito para que, no modo
+// de diagnóstico, as linhas seguintes tenham os endereços corretos e não
+// apareçam erros derivados (ex.: rótulo não definido de LOAD B C)
+void Assembler::discardLine(int address, int position, int words, size_t symbolCount, size_t pendingCount) {
+    for (int pos = position; pos < currentPosition; pos++) {
+        addressList[pos] = 0;
+        wordKinds[pos] = WORD_DATA;
+    }
+    currentAddress = address;
+    currentPosition = position;
+    wordCount = words;
+    pendingOffset = 0;
+    
+    symbolTable.erase(symbolTable.begin() + symbolCount, symbolTable.end());
+    pendingReferences.erase(pendingReferences.begin() + pendingCount, pendingReferences.end());
+    for (auto& pending : pendingReferences) {
+        while (!pending.positions.empty() && pending.positions.back() >= address) {
+            pending.positions.pop_back();
+            pending.offsets.pop_back();
+            pending.lines.pop_back();
+        }
+    }
+}
+
+// Diretivas de módulo, que não geram código:
+//   ROTULO: EXTERN  -> símbolo definido em outro módulo
+//   PUBLIC ROTULO   -> símbolo exportado para os outros módulos
+bool Assembler::processDirective(const vector<string_view>& tokens) {
+    if (tokens.size() != 2) return false;
+    
+    if (tokens[1] == "EXTERN" && isLabel(tokens[0])) {
+        SymbolId label = symbols->intern(tokens[0]);
+        if (findSymbol(label) >= 0) {
+            reportError("Semantico", "Rotulo ja definido");
+            return true;
+        }
+        symbolTable.push_back({label, 0, true});
+        return true;
+    }
+    
+    if (tokens[0] == "PUBLIC" && isLabel(tokens[1])) {
+        SymbolId label = symbols->intern(tokens[1]);
+        if (find(publicLabels.begin(), publicLabels.end(), label) == publicLabels.end()) {
+            publicLabels.push_back(label);
+        }
+        return true;
+    }
+    
+    return false;
+}
+
+// Os tokens são views sobre lineBuffer: válidos até a próxima chamada
+vector<string_view> Assembler::tokenizeLine(string_view line) {
+    vector<string_view> tokens;
+    lineBuffer.resize(line.size());
+    transform(line.begin(), line.end(), lineBuffer.begin(), [](unsigned char ch) { return toupper(ch); });
+    
+    size_t start = 0;
+    for (size_t i = 0; i <= lineBuffer.size(); i++) {
+        char ch = i < lineBuffer.size() ? lineBuffer[i] : ' ';
+        
+        if (ch == ' ' || ch == '\t' || ch == ',' || ch == ':') {
+            if (i > start) {
+                tokens.emplace_back(lineBuffer.data() + start, i - start);
+            }
+            start = i + 1;
+        }
+    }
+    
+    return tokens;
+}
+
+vector<int> Assembler::analyzeTokens(const vector<string_view>& tokens) {
+    vector<int> tokenTypes;
+    int position = 0;
+    
+    for (size_t i = 0; i < tokens.size(); i++) {
+        // Detecta padrão LABEL + NUMBER antes de processar o token atual
+        int offset;
+        if (isLabel(tokens[i]) && 
+            i + 2 < tokens.size() && 
+            tokens[i+1] == "+" && 
+            isNumber(tokens[i+2]) &&
+            parseNumber(tokens[i+2], offset)) {
+            // Seta o offset antes de processar o label
+            pendingOffset = offset;
+        }
+        
+        tokenTypes.push_back(analyzeLexeme(tokens[i], position, tokens));
+        if (tokenTypes.back() == INVALID) break;  // Recupera na próxima linha
+        position++;
+    }
+    
+    return tokenTypes;
+}
+
+int Assembler::analyzeLexeme(string_view str, int position, const vector<string_view>& allTokens) {
+    // Verifica se é palavra reservada
+    auto it = find(RESERVED_WORDS.begin(), RESERVED_WORDS.end(), str);
+    
+    if (it != RESERVED_WORDS.end()) {
+        int tokenType = distance(RESERVED_WORDS.begin(), it);
+        
+        // Tratamento especial para SPACE
+        if (tokenType == SPACE) {
+            // Verifica se SPACE é seguido por um número
+            bool hasNumber = (position + 1 < allTokens.size() && isNumber(allTokens[position + 1]));
+            if (!hasNumber) {
+                // SPACE sem número - adiciona um único zero
+                reserveWord();
+                addressList[currentPosition] = 0;
+                currentPosition++;
+                wordCount++;
+                currentAddress++;
+            }
+        }
+        
+        processReservedWord(tokenType);
+        lastToken = tokenType;
+        return tokenType;
+    }
+    
+    // Verifica se é um rótulo
+    if (isLabel(str)) {
+        SymbolId label = symbols->intern(str);
+        int symbolIndex = findSymbol(label);
+        
+        if (symbolIndex >= 0) {
+            // Rótulo já definido
+            if (position == 0) {
+                reportError("Semantico", "Rotulo ja definido");
+                return INVALID;
+            }
+            if (symbolTable[symbolIndex].external) {
+                // Referências externas ficam na lista de pendências,
+                // que vira a tabela de uso do objeto
+                addToPendingList(label, currentPosition);
+            } else {
+                processLabelReference(label, symbolIndex);
+            }
+        } else {
+            // Rótulo não definido ainda
+            if (position == 0) {
+                processLabelDefinition(label);
+            } else {
+                // Adiciona à lista de pendências
+                addToPendingList(label, currentPosition);
+            }
+        }
+        
+        lastToken = LABEL;
+        return LABEL;
+    }
+    
+    // Verifica se é um número
+    if (isNumber(str)) {
+        int value;
+        if (!parseNumber(str, value)) {
+            reportError("Lexico", "Numero '" + string(str) + "' fora do intervalo");
+            return INVALID;
+        }
+        processNumber(str);
+        return NUMBER;
+    }
+    
+    reportError("Lexico", "Token '" + string(str) + "' invalido");
+    return INVALID;
+}
+
+void Assembler::processReservedWord(int tokenType) {
+    if (tokenType == SPACE) {
+        // Não adiciona nada aqui - será tratado pelo número que segue
+        // ou pelo processamento especial de SPACE sem número
+    } else if (tokenType != CONST && tokenType != PLUS && tokenType != INVALID) {
+        reserveWord();
+        addressList[currentPosition] = tokenType;
+        wordKinds[currentPosition] = WORD_OPCODE;
+        currentPosition++;
+        wordCount++;
+        currentAddress++;
+    }
+}
+
+void Assembler::processLabelReference(SymbolId label, int symbolIndex) {
+    int offset = pendingOffset;  // Captura o offset atual
+    reserveWord();
+    addressList[currentPosition] = symbolTable[symbolIndex].address + offset;
+    wordKinds[currentPosition] = WORD_OPERAND;
+    currentAddress++;
+    currentPosition++;
+    wordCount++;
+    pendingOffset = 0;  // Reset offset
+}
+
+// Os vetores começam com MAX_ADDRESS palavras e crescem com o programa: o
+// limite de memória só é verificado em finish(), depois das otimizações
+void Assembler::reserveWord() {
+    if (currentPosition >= static_cast<int>(addressList.size())) {
+        size_t size = max(addressList.size() * 2, static_cast<size_t>(currentPosition) + 1);
+        addressList.resize(size, 0);
+        wordKinds.resize(size, WORD_DATA);
+    }
+}
+
+void Assembler::processLabelDefinition(SymbolId label) {
+    addToSymbolTable(label, currentAddress);
+}
+
+void Assembler::processNumber(string_view str) {
+    wordCount++;
+    int value = 0;
+    parseNumber(str, value);  // Já validado em analyzeLexeme
+    
+    if (lastToken == STOP) {
+        currentAddress += value;
+        currentPosition++;
+    } else if (lastToken == PLUS) {
+        // Este é um offset para uma expressão LABEL + NUMBER
+        pendingOffset = value;
+        wordCount--;  // Não conta o número como palavra separada
+    } else if (lastToken == SPACE) {
+        // SPACE seguido de NUMBER: adiciona 'value' zeros
+        wordCount--; // Remove a contagem extra do wordCount++
+        for (int i = 0; i < value; i++) {
+            reserveWord();
+            addressList[currentPosition] = 0;
+            currentPosition++;
+            wordCount++;
+            currentAddress++;
+        }
+    } else {
+        reserveWord();
+        addressList[currentPosition] = value;
+        currentAddress++;
+        currentPosition++;
+    }
+}
+
+bool Assembler::isSyntaxValid(const vector<int>& tokens) {
+    if (tokens.empty()) return true;
+    return find(SYNTAX_RULES.begin(), SYNTAX_RULES.end(), tokens) != SYNTAX_RULES.end();
+}
+
+bool Assembler::isLabel(string_view str) {
+    if (str.empty() || (!isalpha(str[0]) && str[0] != '_')) {
+        return false;
+    }
+    
+    for (size_t i = 1; i < str.length(); i++) {
+        if (!isalnum(str[i]) && str[i] != '_') {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+bool Assembler::isNumber(string_view str) {
+    if (str.empty()) return false;
+    
+    for (char ch : str) {
+        if (!isdigit(ch)) return false;
+    }
+    
+    return true;
+}
+
+int Assembler::findSymbol(SymbolId label) {
+    for (size_t i = 0; i < symbolTable.size(); i++) {
+        if (symbolTable[i].label == label) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int Assembler::findPending(SymbolId label) {
+    for (size_t i = 0; i < pendingReferences.size(); i++) {
+        if (pendingReferences[i].label == label) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void Assembler::addToSymbolTable(SymbolId label, int address) {
+    symbolTable.push_back({label, address});
+}
+
+void Assembler::addToPendingList(SymbolId label, int position) {
+    wordCount++;
+    int pendingIndex = findPending(label);
+    int offset = pendingOffset;  // Captura o offset atual
+    reserveWord();
+    wordKinds[currentPosition] = WORD_OPERAND;
+    
+    if (pendingIndex >= 0) {
+        // Já existe na lista de pendências
+        pendingReferences[pendingIndex].positions.push_back(currentAddress);
+        pendingReferences[pendingIndex].offsets.push_back(offset);
+        pendingReferences[pendingIndex].lines.push_back(currentLine);
+    } else {
+        // Cria nova entrada
+        PendingReference newPending;
+        newPending.label = label;
+        newPending.positions.push_back(currentAddress);
+        newPending.offsets.push_back(offset);
+        newPending.lines.push_back(currentLine);
+        pendingReferences.push_back(newPending);
+    }
+    
+    currentAddress++;
+    currentPosition++;
+    pendingOffset = 0;  // Reset offset
+}
+
+void Assembler::resolvePendingReferences() {
+    for (const auto& pending : pendingReferences) {
+        int symbolIndex = findSymbol(pending.label);
+        
+        if (symbolIndex == -1) {
+            throw runtime_error("Erro Semantico: rotulo nao definido: " + symbols->str(pending.label));
+        }
+        
+        int baseAddress = symbolTable[symbolIndex].address;
+        
+        for (size_t i = 0; i < pending.positions.size(); i++) {
+            int pos = pending.positions[i];
+            int offset = pending.offsets[i];
+            addressList[pos] = baseAddress + offset;
+            if (symbolTable[symbolIndex].external) {
+                wordKinds[pos] = WORD_EXTERNAL;
+            }
+        }
+    }
+}
+
+void Assembler::showSymbolTable() {
+    cout << "====================\n";
+    cout << "=Tabela de Simbolos=\n";
+    cout << "====================\n\n";
+    
+    for (const auto& entry : symbolTable) {
+        cout << symbols->name(entry.label) << " (&" << entry.address << ")\n";
+    }
+    cout << "\n";
+}
+
+void Assembler::showPendingReferences() {
+    cout << "=====================\n";
+    cout << "=Lista de Pendencias=\n";
+    cout << "=====================\n\n";
+    
+    for (const auto& pending : pendingReferences) {
+        cout << symbols->name(pending.label) << " [ ";
+        for (size_t i = 0; i < pending.positions.size(); i++) {
+            cout << pending.positions[i];
+            if (pending.offsets[i] > 0) {
+                cout << "+" << pending.offsets[i];
+            }
+            cout << " ";
+        }
+        cout << "]\n";
+    }
+    cout << "\n";
+}
+
+void Assembler::showRawOutput() {
+    // Mostra saída não tratada (com pendências como linked list)
+    vector<int> tempList = addressList;
+    
+    for (const auto& pending : pendingReferences) {
+        int previous = -1;
+        for (int pos : pending.positions) {
+            tempList[pos] = previous;
+            previous = pos;
+        }
+    }
+    
+    for (int i = 0; i < wordCount; i++) {
+        cout << tempList[i] << " ";
+    }
+    cout << "\n";
+}
+
+void Assembler::showFinalOutput() {
+    resolvePendingReferences();
+    
+    for (int i = 0; i < wordCount; i++) {
+        cout << addressList[i] << " ";
+    }
+    cout << "\n";
+}
+
+string Assembler::formatRawOutput() {
+    // Saída não tratada (com pendências como linked list)
+    vector<int> tempList = addressList;
+    
+    for (const auto& pending : pendingReferences) {
+        int previous = -1;
+        for (int pos : pending.positions) {
+            tempList[pos] = previous;
+            previous = pos;
+        }
+    }
+    
+    ostringstream out;
+    for (int i = 0; i < wordCount; i++) {
+        out << tempList[i];
+        if (i < wordCount - 1) out << " ";
+    }
+    out << "\n";
+    return out.str();
+}
+
+string Assembler::formatFinalOutput() {
+    if (hasExternalSymbols()) {
+        throw runtime_error("Modulo com simbolos EXTERN deve ser gerado com a opcao obj e ligado");
+    }
+    
+    resolvePendingReferences();
+    
+    ostringstream out;
+    for (int i = 0; i < wordCount; i++) {
+        out << addressList[i];
+        if (i < wordCount - 1) out << " ";
+    }
+    out << "\n";
+    return out.str();
+}
+
+void Assembler::writeOutputFile(const string& outputFile, const string& content) {
+    ofstream file(outputFile);
+    
+    if (!file.is_open()) {
+        throw runtime_error("Nao foi possivel criar o arquivo " + outputFile);
+    }
+    
+    file << content;
+    file.close();
+    cout << "Arquivo " << outputFile << " gerado com sucesso.\n";
+}
+
+void Assembler::writeRawOutput(const string& filename) {
+    writeOutputFile(getBaseFilename(filename) + ".o1", formatRawOutput());
+}
+
+void Assembler::writeFinalOutput(const string& filename) {
+    writeOutputFile(getBaseFilename(filename) + ".o2", formatFinalOutput());
+}
+
+bool Assembler::hasExternalSymbols() {
+    for (const auto& entry : symbolTable) {
+        if (entry.external) return true;
+    }
+    return false;
+}
+
+// Objeto relocável (.obj) para o ligador, montado a partir do endereço 0:
+//   H: <nome do módulo>
+//   H: <tamanho em palavras>
+//   D: <rotulo> <endereço>              tabela de definições (PUBLIC)
+//   U: <rotulo> <posição> <offset>      tabela de uso (EXTERN), uma por referência
+//   R: <bit por palavra>                1 = endereço relativo, somar a base do módulo
+//   T: <código>
+string Assembler::formatObjectOutput(const string& moduleName) {
+    resolvePendingReferences();
+    
+    ostringstream file;
+    file << "H: " << moduleName << "\n";
+    file << "H: " << wordCount << "\n";
+    
+    for (const auto& label : publicLabels) {
+        int symbolIndex = findSymbol(label);
+        if (symbolIndex == -1 || symbolTable[symbolIndex].external) {
+            throw runtime_error("Erro Semantico: rotulo publico nao definido: " + symbols->str(label));
+        }
+        file << "D: " << symbols->name(label) << " " << symbolTable[symbolIndex].address << "\n";
+    }
+    
+    for (const auto& pending : pendingReferences) {
+        int symbolIndex = findSymbol(pending.label);
+        if (!symbolTable[symbolIndex].external) continue;
+        for (size_t i = 0; i < pending.positions.size(); i++) {
+            file << "U: " << symbols->name(pending.label) << " " << pending.positions[i] << " " << pending.offsets[i] << "\n";
+        }
+    }
+    
+    file << "R:";
+    for (int i = 0; i < wordCount; i++) {
+        file << " " << (wordKinds[i] == WORD_OPERAND ? 1 : 0);
+    }
+    file << "\n";
+    
+    file << "T:";
+    for (int i = 0; i < wordCount; i++) {
+        file << " " << addressList[i];
+    }
+    file << "\n";
+    
+    return file.str();
+}
+
+void Assembler::writeObjectOutput(const string& filename) {
+    writeOutputFile(getBaseFilename(filename) + ".obj", formatObjectOutput(getBaseFilename(filename)));
+}
+
+// Gera o .dbg: mapa endereço -> linha do .pre, tabela de símbolos e, se o
+// pré-processador gerou o .pmap ao lado do .pre, a origem .asm/macro de cada linha
+void Assembler::writeDebugInfo(const string& filename) {
+    string outputFile = getBaseFilename(filename) + ".dbg";
+    
+    size_t lastDot = filename.find_last_of(".");
+    size_t lastSlash = filename.find_last_of("/\\");
+    bool hasExtension = lastDot != string::npos && (lastSlash == string::npos || lastDot > lastSlash);
+    debugInfo.loadLineOrigins((hasExtension ? filename.substr(0, lastDot) : filename) + ".pmap");
+    
+    for (const auto& entry : symbolTable) {
+        debugInfo.addSymbol(symbols->str(entry.label), entry.address);
+    }
+    
+    debugInfo.write(outputFile);
+    cout << "Arquivo " << outputFile << " gerado com sucesso.\n";
+}
+
+string Assembler::getBaseFilename(const string& fullPath) {
+    // Remove o diretório do caminho
+    size_t lastSlash = fullPath.find_last_of("/\\");
+    string filename = (lastSlash != string::npos) ? fullPath.substr(lastSlash + 1) : fullPath;
+    
+    // Remove a extensão
+    size_t lastDot = filename.find_last_of(".");
+    if (lastDot != string::npos) {
+        filename = filename.substr(0, lastDot);
+    }
+    
+    return filename;
+}
+
+void Assembler::showAll() {
+    showSymbolTable();
+    showPendingReferences();
+    
+    cout << "======================\n";
+    cout << "= Codigo sem correcao=\n";
+    cout << "=    de pendencias   =\n";
+    cout << "======================\n";
+    showRawOutput();
+    
+    cout << "\n";
+    cout << "==============\n";
+    cout << "=    Final   =\n";
+    cout << "==============\n\n";
+    showFinalOutput();
+}
+
+void Assembler::displayOutput(const string& option) {
+    if (option == "all") {
+        showAll();
+    } else if (option == "o1") {
+        showRawOutput();
+    } else if (option == "o2") {
+        showFinalOutput();
+    } else {
+        cout << "Insira um argumento valido: all, o1, o2.\n";
+    }
+}
+
+void Assembler::generateOutputFiles(const string& inputFilename, const string& option) {
+    if (option == "all") {
+        showAll();
+        writeRawOutput(inputFilename);
+        writeFinalOutput(inputFilename);
+    } else if (option == "o1") {
+        writeRawOutput(inputFilename);
+    } else if (option == "o2") {
+        writeFinalOutput(inputFilename);
+    } else if (option == "obj") {
+        writeObjectOutput(inputFilename);
+    } else {
+        cout << "Insira um argumento valido: all, o1, o2, obj.\n";
+        return;
+    }
+    
+    if (emitDebugInfo) {
+        writeDebugInfo(inputFilename);
+    }
+    if (analyzeFlow) {
+        writeFlowAnalysis(inputFilename);
+    }
+}
+
+// Análise estática sobre o código já resolvido (e otimizado, se pedido)
+pair<string, string> Assembler::formatFlowAnalysis(const string& name) {
+    resolvePendingReferences();
+    
+    vector<char> opcodeAt(wordCount), externalAt(wordCount);
+    for (int pos = 0; pos < wordCount; pos++) {
+        opcodeAt[pos] = wordKinds[pos] == WORD_OPCODE;
+        externalAt[pos] = wordKinds[pos] == WORD_EXTERNAL;
+    }
+    
+    FlowAnalysis analysis(addressList, opcodeAt, externalAt, wordCount);
+    for (const auto& entry : symbolTable) {
+        if (!entry.external) analysis.setLabel(entry.address, symbols->str(entry.label));
+    }
+    analysis.run();
+    return {analysis.report(), analysis.dot(name)};
+}
+
+void Assembler::writeFlowAnalysis(const string& filename) {
+    string base = getBaseFilename(filename);
+    auto analysis = formatFlowAnalysis(base);
+    writeOutputFile(base + ".cfg", analysis.first);
+    writeOutputFile(base + ".dot", analysis.second);
+}
+
+// ============================================================================
+// OTIMIZAÇÃO PEEPHOLE
+// ============================================================================
+
+int Assembler::instructionSize(int opcode) {
+    if (opcode == COPY) return 3;
+    if (opcode == STOP) return 1;
+    return 2;
+}
+
+// Executada sobre o código já resolvido. Repete até não haver mudanças:
+// encadeamento de desvios, remoção de JMP para a próxima instrução e de
+// LOAD logo após STORE no mesmo endereço, seguida de nova alocação de endereços.
+void Assembler::optimize() {
+    resolvePendingReferences();
+    int originalSize = wordCount;
+    
+    bool changed = true;
+    while (changed) {
+        changed = threadJumpChains();
+        
+        vector<bool> removed(wordCount, false);
+        if (markRedundantInstructions(removed)) {
+            relayout(removed);
+            changed = true;
+        }
+    }
+    
+    *log << "Otimizacao: " << originalSize << " -> " << wordCount << " palavras.\n";
+}
+
+// Passo sobre a área de dados: CONSTs nunca escritas (alvo de STORE, INPUT ou
+// destino de COPY) com o mesmo valor são unidas, e dados que nenhuma
+// instrução referencia são removidos. Com memória de 216 palavras isso pode
+// decidir se o programa cabe.
+void Assembler::optimizeDataSection() {
+    resolvePendingReferences();
+    int originalSize = wordCount;
+    
+    // Bloco de dados que contém cada posição (-1 fora de dados)
+    vector<int> blockAt(wordCount + 1, -1);
+    for (size_t b = 0; b < dataBlocks.size(); b++) {
+        for (int i = 0; i < dataBlocks[b].size; i++) {
+            blockAt[dataBlocks[b].start + i] = b;
+        }
+    }
+    
+    vector<bool> referenced(dataBlocks.size(), false);
+    vector<bool> written(dataBlocks.size(), false);
+    
+    // Símbolos exportados podem ser lidos e escritos por outros módulos
+    for (const auto& label : publicLabels) {
+        int symbolIndex = findSymbol(label);
+        if (symbolIndex < 0) continue;
+        int address = symbolTable[symbolIndex].address;
+        if (address >= 0 && address <= wordCount && blockAt[address] >= 0) {
+            referenced[blockAt[address]] = written[blockAt[address]] = true;
+        }
+    }
+    int lastOpcode = INVALID;
+    int operandIndex = 0;
+    for (int pos = 0; pos < wordCount; pos++) {
+        if (wordKinds[pos] == WORD_OPCODE) {
+            lastOpcode = addressList[pos];
+            operandIndex = 0;
+            continue;
+        }
+        if (wordKinds[pos] != WORD_OPERAND && wordKinds[pos] != WORD_EXTERNAL) continue;
+        
+        operandIndex++;
+        if (wordKinds[pos] == WORD_EXTERNAL) continue;
+        int target = addressList[pos];
+        if (target < 0 || target > wordCount || blockAt[target] < 0) continue;
+        
+        referenced[blockAt[target]] = true;
+        if (lastOpcode == STORE || lastOpcode == INPUT || (lastOpcode == COPY && operandIndex == 2)) {
+            written[blockAt[target]] = true;
+        }
+    }
+    
+    // Pendências com offset (LOAD X + 1) podem apontar para fora do bloco do
+    // rótulo: o bloco de X continua usado, pois o rótulo precisa existir, e não
+    // é unido a outro, senão X + 1 passaria a apontar para outro lugar
+    vector<bool> offsetUse(dataBlocks.size(), false);
+    for (const auto& pending : pendingReferences) {
+        int symbolIndex = findSymbol(pending.label);
+        if (symbolIndex < 0 || symbolTable[symbolIndex].external) continue;
+        int address = symbolTable[symbolIndex].address;
+        if (address < 0 || address > wordCount || blockAt[address] < 0) continue;
+        referenced[blockAt[address]] = true;
+        for (int offset : pending.offsets) {
+            if (offset != 0) offsetUse[blockAt[address]] = true;
+        }
+    }
+    
+    // Une constantes somente leitura de mesmo valor na primeira ocorrência
+    vector<int> canonical(dataBlocks.size(), -1);
+    for (size_t b = 0; b < dataBlocks.size(); b++) {
+        const DataBlock& block = dataBlocks[b];
+        if (!block.isConst || block.size != 1 || written[b] || !referenced[b] || offsetUse[b]) continue;
+        
+        for (size_t c = 0; c < b; c++) {
+            const DataBlock& other = dataBlocks[c];
+            if (other.isConst && other.size == 1 && !written[c] && referenced[c] && canonical[c] < 0 &&
+                addressList[other.start] == addressList[block.start]) {
+                canonical[b] = c;
+                break;
+            }
+        }
+    }
+    
+    for (int pos = 0; pos < wordCount; pos++) {
+        if (wordKinds[pos] != WORD_OPERAND) continue;
+        int target = addressList[pos];
+        if (target >= 0 && target <= wordCount && blockAt[target] >= 0 && canonical[blockAt[target]] >= 0) {
+            addressList[pos] = dataBlocks[canonical[blockAt[target]]].start;
+        }
+    }
+    
+    // Rótulos das constantes unidas passam a apontar para a canônica; os
+    // rótulos de dados removidos saem da tabela de símbolos
+    vector<bool> removed(wordCount, false);
+    vector<bool> dropped(dataBlocks.size(), false);
+    for (size_t b = 0; b < dataBlocks.size(); b++) {
+        if (referenced[b] && canonical[b] < 0) continue;
+        dropped[b] = !referenced[b];
+        for (int i = 0; i < dataBlocks[b].size; i++) {
+            removed[dataBlocks[b].start + i] = true;
+        }
+    }
+    
+    vector<SymbolTableEntry> keptSymbols;
+    for (auto& entry : symbolTable) {
+        int b = (!entry.external && entry.address >= 0 && entry.address <= wordCount) ? blockAt[entry.address] : -1;
+        if (b >= 0 && dropped[b]) continue;
+        if (b >= 0 && canonical[b] >= 0) entry.address = dataBlocks[canonical[b]].start;
+        keptSymbols.push_back(entry);
+    }
+    symbolTable = keptSymbols;
+    
+    relayout(removed);
+    dataBlocks.clear();
+    
+    *log << "Otimizacao de dados: " << originalSize << " -> " << wordCount << " palavras.\n";
+}
+
+// Desvios cujo destino é um JMP passam a apontar para o destino final
+bool Assembler::threadJumpChains() {
+    bool changed = false;
+    
+    for (int pos = 0; pos < wordCount; pos++) {
+        int opcode = addressList[pos];
+        if (wordKinds[pos] != WORD_OPCODE || opcode < JMP || opcode > JMPZ) continue;
+        
+        if (wordKinds[pos + 1] != WORD_OPERAND) continue;
+        int target = addressList[pos + 1];
+        int hops = 0;
+        // Operando EXTERN guarda um offset do outro módulo, não um endereço
+        while (target >= 0 && target + 1 < wordCount && wordKinds[target] == WORD_OPCODE &&
+               addressList[target] == JMP && wordKinds[target + 1] == WORD_OPERAND &&
+               addressList[target + 1] != target && hops < wordCount) {
+            target = addressList[target + 1];
+            hops++;
+        }
+        
+        if (target != addressList[pos + 1]) {
+            addressList[pos + 1] = target;
+            retargetPending(pos + 1, target);
+            changed = true;
+        }
+    }
+    
+    return changed;
+}
+
+// Um operando alterado pela otimização pode ser uma referência pendente:
+// o offset passa a levar ao novo valor, senão resolvePendingReferences()
+// restauraria o destino antigo
+void Assembler::retargetPending(int position, int value) {
+    for (auto& pending : pendingReferences) {
+        for (size_t i = 0; i < pending.positions.size(); i++) {
+            if (pending.positions[i] != position) continue;
+            int symbolIndex = findSymbol(pending.label);
+            if (symbolIndex >= 0) pending.offsets[i] = value - symbolTable[symbolIndex].address;
+            return;
+        }
+    }
+}
+
+bool Assembler::markRedundantInstructions(vector<bool>& removed) {
+    // Endereços que podem ser alcançados por desvio ou rótulo não podem
+    // perder a instrução, pois o fluxo pode chegar ali por outro caminho
+    vector<bool> referenced(wordCount + 1, false);
+    for (int pos = 0; pos < wordCount; pos++) {
+        int value = addressList[pos];
+        if (wordKinds[pos] == WORD_OPERAND && value >= 0 && value <= wordCount) {
+            referenced[value] = true;
+        }
+    }
+    for (const auto& entry : symbolTable) {
+        if (entry.address >= 0 && entry.address <= wordCount) referenced[entry.address] = true;
+    }
+    
+    bool changed = false;
+    int pos = 0;
+    while (pos < wordCount) {
+        if (wordKinds[pos] != WORD_OPCODE) {
+            pos++;
+            continue;
+        }
+        
+        int opcode = addressList[pos];
+        int next = pos + instructionSize(opcode);
+        
+        if (opcode == JMP && wordKinds[pos + 1] == WORD_OPERAND && addressList[pos + 1] == next) {
+            // JMP para a instrução seguinte
+            removed[pos] = removed[pos + 1] = true;
+            changed = true;
+        } else if (opcode == STORE && wordKinds[pos + 1] == WORD_OPERAND &&
+                   next + 1 < wordCount && wordKinds[next] == WORD_OPCODE &&
+                   addressList[next] == LOAD && wordKinds[next + 1] == WORD_OPERAND &&
+                   addressList[next + 1] == addressList[pos + 1] && !referenced[next]) {
+            // STORE X seguido de LOAD X: o acumulador já contém X. Os dois
+            // operandos precisam ser endereços locais; um EXTERN de mesmo valor
+            // é um offset em outro módulo
+            removed[next] = removed[next + 1] = true;
+            changed = true;
+            next += 2;
+        }
+        
+        pos = next;
+    }
+    
+    return changed;
+}
+
+// Compacta o código removendo as palavras marcadas e reescreve todas as
+// referências. Um endereço removido passa a apontar para a próxima palavra mantida.
+void Assembler::relayout(const vector<bool>& removed) {
+    vector<int> newAddress(wordCount + 1, 0);
+    int kept = 0;
+    for (int pos = 0; pos < wordCount; pos++) {
+        newAddress[pos] = kept;
+        if (!removed[pos]) {
+            addressList[kept] = addressList[pos];
+            wordKinds[kept] = wordKinds[pos];
+            kept++;
+        }
+    }
+    newAddress[wordCount] = kept;
+    
+    for (int pos = kept; pos < wordCount; pos++) {
+        addressList[pos] = 0;
+        wordKinds[pos] = WORD_DATA;
+    }
+    
+    for (int pos = 0; pos < kept; pos++) {
+        int value = addressList[pos];
+        if (wordKinds[pos] == WORD_OPERAND && value >= 0 && value <= wordCount) {
+            addressList[pos] = newAddress[value];
+        }
+    }
+    
+    for (auto& entry : symbolTable) {
+        int oldAddress = entry.address;
+        if (oldAddress >= 0 && oldAddress <= wordCount) entry.address = newAddress[oldAddress];
+    }
+    
+    // Pendências: as posições removidas saem da lista (com a palavra some a
+    // relocação), as demais são remapeadas e os offsets recalculados a partir
+    // do operando já reescrito. Sem o rótulo na tabela o offset é mantido
+    for (auto& pending : pendingReferences) {
+        int symbolIndex = findSymbol(pending.label);
+        PendingReference updated;
+        updated.label = pending.label;
+        for (size_t i = 0; i < pending.positions.size(); i++) {
+            int pos = pending.positions[i];
+            if (pos < 0 || pos >= wordCount || removed[pos]) continue;
+            updated.positions.push_back(newAddress[pos]);
+            if (symbolIndex >= 0 && !symbolTable[symbolIndex].external) {
+                updated.offsets.push_back(addressList[newAddress[pos]] - symbolTable[symbolIndex].address);
+            } else {
+                updated.offsets.push_back(pending.offsets[i]);
+            }
+            updated.lines.push_back(pending.lines[i]);
+        }
+        pending = updated;
+    }
+    
+    if (emitDebugInfo) {
+        DebugInfo remapped;
+        for (size_t i = 0; i < debugInfo.addresses.size(); i++) {
+            int address = newAddress[min(debugInfo.addresses[i], wordCount)];
+            // Linhas totalmente removidas colapsam na linha seguinte
+            if (!remapped.addresses.empty() && remapped.addresses.back() == address) {
+                remapped.preLines.back() = debugInfo.preLines[i];
+            } else {
+                remapped.addresses.push_back(address);
+                remapped.preLines.push_back(debugInfo.preLines[i]);
+            }
+        }
+        debugInfo.addresses = remapped.addresses;
+        debugInfo.preLines = remapped.preLines;
+    }
+    
+    int removedCount = wordCount - kept;
+    wordCount = kept;
+    currentAddress -= removedCount;
+    currentPosition -= removedCount;
+}
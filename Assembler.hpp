@@ -0,0 +1,143 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "DebugInfo.hpp"
+#include "Diagnostic.hpp"
+#include "SymbolPool.hpp"
+
+// ============================================================================
+// ESTRUTURAS DE DADOS
+// ============================================================================
+
+struct SymbolTableEntry {
+    SymbolId label;
+    int address;
+    bool external = false;  // Declarado com EXTERN: resolvido pelo ligador
+};
+
+struct DataBlock {
+    int start;     // Primeira posição da linha de dados
+    int size;      // Quantidade de palavras (CONST = 1, SPACE N = N)
+    bool isConst;
+};
+
+struct PendingReference {
+    SymbolId label;
+    std::vector<int> positions;
+    std::vector<int> offsets;  // Offset para cada posição (0 se não houver offset)
+    std::vector<int> lines;    // Linha do .pre de cada uso (para diagnósticos)
+};
+
+class Assembler {
+private:
+    // Contadores
+    int currentLine;
+    int currentAddress;
+    int currentPosition;
+    int wordCount;
+    int lastToken;
+    int pendingOffset;  // Offset temporário para expressões LABEL + NUMBER
+    bool emitDebugInfo; // Gera o arquivo .dbg (linhas, símbolos e macros)
+    bool optimizeCode;  // Aplica a otimização peephole antes da saída
+    bool optimizeData;  // Une constantes iguais e remove dados não usados
+    bool keepGoing;     // Modo de diagnóstico: acumula erros em vez de parar no primeiro
+    bool analyzeFlow;   // Gera o relatório de fluxo de controle (.cfg) e o grafo (.dot)
+    std::ostream* log;  // Mensagens das otimizações (padrão: cout)
+    
+    // Estruturas de dados
+    SymbolPool ownSymbols;
+    SymbolPool* symbols;         // Rótulos internados; pode ser compartilhada com o Preprocessor
+    std::string lineBuffer;      // Linha atual em maiúsculas; os tokens apontam para ela
+    std::vector<int> addressList;
+    std::vector<int> wordKinds;  // WordKind de cada posição de addressList
+    std::vector<SymbolTableEntry> symbolTable;
+    std::vector<PendingReference> pendingReferences;
+    std::vector<DataBlock> dataBlocks;
+    std::vector<SymbolId> publicLabels;
+    DebugInfo debugInfo;
+    std::vector<Diagnostic> diagnostics;
+    
+    // Métodos auxiliares
+    void processLine(std::string_view line);
+    void discardLine(int address, int position, int words, size_t symbolCount, size_t pendingCount);
+    std::vector<std::string_view> tokenizeLine(std::string_view line);
+    std::vector<int> analyzeTokens(const std::vector<std::string_view>& tokens);
+    int analyzeLexeme(std::string_view str, int position, const std::vector<std::string_view>& allTokens);
+    bool isSyntaxValid(const std::vector<int>& tokens);
+    bool isLabel(std::string_view str);
+    bool isNumber(std::string_view str);
+    int findSymbol(SymbolId label);
+    int findPending(SymbolId label);
+    void addToSymbolTable(SymbolId label, int address);
+    void addToPendingList(SymbolId label, int position);
+    void resolvePendingReferences();
+    void processReservedWord(int tokenType);
+    void reserveWord();
+    void processLabelReference(SymbolId label, int position);
+    void processLabelDefinition(SymbolId label);
+    void processNumber(std::string_view str);
+    bool processDirective(const std::vector<std::string_view>& tokens);
+    void reportError(const std::string& kind, const std::string& detail);
+    void reportUndefinedLabels();
+    bool hasExternalSymbols();
+    
+    // Otimização peephole
+    void optimize();
+    void optimizeDataSection();
+    bool threadJumpChains();
+    void retargetPending(int position, int value);
+    bool markRedundantInstructions(std::vector<bool>& removed);
+    void relayout(const std::vector<bool>& removed);
+    static int instructionSize(int opcode);
+    
+    // Métodos de exibição
+    void showSymbolTable();
+    void showPendingReferences();
+    void showRawOutput();
+    void showFinalOutput();
+    void showAll();
+    
+    // Novos métodos para escrita em arquivo
+    void writeOutputFile(const std::string& outputFile, const std::string& content);
+    void writeRawOutput(const std::string& filename);
+    void writeFinalOutput(const std::string& filename);
+    void writeDebugInfo(const std::string& filename);
+    void writeObjectOutput(const std::string& filename);
+    void writeFlowAnalysis(const std::string& filename);
+    std::string getBaseFilename(const std::string& fullPath);
+
+public:
+    Assembler();
+    Assembler(const Assembler&) = delete;
+    Assembler& operator=(const Assembler&) = delete;
+    // Usa uma tabela de símbolos externa (ex.: a mesma do Preprocessor); reset() não a limpa
+    void setSymbolPool(SymbolPool& pool) { symbols = &pool; }
+    void setDebugInfo(bool enabled) { emitDebugInfo = enabled; }
+    void setOptimization(bool enabled) { optimizeCode = enabled; }
+    void setDataOptimization(bool enabled) { optimizeData = enabled; }
+    void setLog(std::ostream& out) { log = &out; }
+    void setDiagnosticsMode(bool enabled) { keepGoing = enabled; }
+    void setFlowAnalysis(bool enabled) { analyzeFlow = enabled; }
+    const std::vector<Diagnostic>& getDiagnostics() const { return diagnostics; }
+    void reset();
+    void compile(const std::string& filename);
+    void compile(std::istream& input);
+    // Interface incremental (ex.: pipeline): feedLine() para cada linha do
+    // .pre em ordem e finish() no fim; compile() é equivalente
+    void feedLine(std::string_view line);
+    void finish();
+    
+    // Conteúdo dos arquivos de saída, sem escrever em disco
+    std::string formatRawOutput();
+    std::string formatFinalOutput();
+    std::string formatObjectOutput(const std::string& moduleName);
+    // Relatório (.cfg) e grafo em DOT da análise de fluxo de controle
+    std::pair<std::string, std::string> formatFlowAnalysis(const std::string& name);
+    
+    void displayOutput(const std::string& option);
+    void generateOutputFiles(const std::string& inputFilename, const std::string& option);
+};
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Informação de depuração gerada ao lado do .o1/.o2 (arquivo .dbg).
+//
+// Formato (texto, uma seção por linha, valores separados por espaço):
+//   SBDBG 1
+//   A <n> <dEnd> <dLinha> ...     endereço -> linha do .pre, delta em relação à entrada anterior
+//   S <n> <rotulo> <end> ...      tabela de símbolos, ordenada por endereço
+//   O <n> <pilha> ...             pilhas de chamada de macro distintas ("-" = fora de macro)
+//   P <n> <dLinhaAsm> <origem> ... linha do .pre -> linha do .asm (delta) e índice em O
+//
+// Todas as tabelas ficam ordenadas, então as consultas são buscas binárias.
+struct DebugInfo {
+    struct Symbol {
+        std::string label;
+        int address;
+    };
+
+    std::vector<int> addresses;      // primeiro endereço de cada linha do .pre que gerou palavras
+    std::vector<int> preLines;       // linha do .pre correspondente (paralelo a addresses)
+    std::vector<Symbol> symbols;     // ordenada por endereço
+    std::vector<std::string> origins;
+    std::vector<int> asmLines;       // índice = linha do .pre - 1
+    std::vector<int> originIds;      // índice = linha do .pre - 1
+
+    // linha do .pre que gerou o endereço, 0 se desconhecida
+    int preLineForAddress(int address) const {
+        auto it = std::upper_bound(addresses.begin(), addresses.end(), address);
+        if (it == addresses.begin()) return 0;
+        return preLines[std::distance(addresses.begin(), it) - 1];
+    }
+
+    // linha do .asm da linha do .pre, 0 se desconhecida
+    int asmLineForPreLine(int preLine) const {
+        if (preLine < 1 || preLine > static_cast<int>(asmLines.size())) return 0;
+        return asmLines[preLine - 1];
+    }
+
+    // pilha de macros da linha do .pre ("SQR@28>DUP@7"), "-" fora de macro
+    const std::string& originForPreLine(int preLine) const {
+        static const std::string none = "-";
+        if (preLine < 1 || preLine > static_cast<int>(originIds.size())) return none;
+        return origins[originIds[preLine - 1]];
+    }
+
+    // símbolo de maior endereço <= address, nullptr se não houver
+    const Symbol* symbolForAddress(int address) const {
+        auto it = std::upper_bound(symbols.begin(), symbols.end(), address,
+                                   [](int a, const Symbol& s) { return a < s.address; });
+        if (it == symbols.begin()) return nullptr;
+        return &*std::prev(it);
+    }
+
+    void addSymbol(const std::string& label, int address) {
+        Symbol s{label, address};
+        auto it = std::upper_bound(symbols.begin(), symbols.end(), s,
+                                   [](const Symbol& x, const Symbol& y) { return x.address < y.address; });
+        symbols.insert(it, s);
+    }
+
+    // carrega o .pmap do pré-processador ("<linha .asm> <pilha>" por linha do .pre)
+    void loadLineOrigins(const std::string& pmapFile) {
+        std::ifstream fin(pmapFile);
+        if (!fin.is_open()) return;
+        std::map<std::string, int> ids;
+        for (size_t i = 0; i < origins.size(); ++i) ids[origins[i]] = static_cast<int>(i);
+
+        int asmLine;
+        std::string stack;
+        while (fin >> asmLine >> stack) {
+            auto it = ids.find(stack);
+            if (it == ids.end()) {
+                it = ids.insert({stack, static_cast<int>(origins.size())}).first;
+                origins.push_back(stack);
+            }
+            asmLines.push_back(asmLine);
+            originIds.push_back(it->second);
+        }
+    }
+
+    void write(const std::string& filename) const {
+        std::ofstream out(filename);
+        if (!out.is_open()) throw std::runtime_error("Nao foi possivel criar o arquivo " + filename);
+
+        out << "SBDBG 1\n";
+        out << "A " << addresses.size();
+        int prevAddress = 0, prevLine = 0;
+        for (size_t i = 0; i < addresses.size(); ++i) {
+            out << " " << addresses[i] - prevAddress << " " << preLines[i] - prevLine;
+            prevAddress = addresses[i];
+            prevLine = preLines[i];
+        }
+        out << "\nS " << symbols.size();
+        for (const auto& s : symbols) out << " " << s.label << " " << s.address;
+        out << "\nO " << origins.size();
+        for (const auto& o : origins) out << " " << o;
+        out << "\nP " << asmLines.size();
+        int prevAsm = 0;
+        for (size_t i = 0; i < asmLines.size(); ++i) {
+            out << " " << asmLines[i] - prevAsm << " " << originIds[i];
+            prevAsm = asmLines[i];
+        }
+        out << "\n";
+    }
+
+    // retorna false se o arquivo não existir
+    bool read(const std::string& filename) {
+        std::ifstream in(filename);
+        if (!in.is_open()) return false;
+
+        std::string magic;
+        int version = 0;
+        if (!(in >> magic >> version) || magic != "SBDBG" || version != 1)
+            throw std::runtime_error("Arquivo de depuracao invalido: " + filename);
+
+        *this = DebugInfo();
+        std::string section;
+        size_t n;
+        while (in >> section >> n) {
+            if (section == "A") {
+                int address = 0, line = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    int dAddress, dLine;
+                    in >> dAddress >> dLine;
+                    addresses.push_back(address += dAddress);
+                    preLines.push_back(line += dLine);
+                }
+            } else if (section == "S") {
+                for (size_t i = 0; i < n; ++i) {
+                    Symbol s;
+                    in >> s.label >> s.address;
+                    symbols.push_back(s);
+                }
+            } else if (section == "O") {
+                origins.resize(n);
+                for (auto& o : origins) in >> o;
+            } else if (section == "P") {
+                int line = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    int dLine, id;
+                    in >> dLine >> id;
+                    asmLines.push_back(line += dLine);
+                    originIds.push_back(id);
+                }
+            } else {
+                throw std::runtime_error("Secao desconhecida '" + section + "' em " + filename);
+            }
+            if (!in) throw std::runtime_error("Arquivo de depuracao truncado: " + filename);
+        }
+        for (int id : originIds) {
+            if (id < 0 || id >= static_cast<int>(origins.size()))
+                throw std::runtime_error("Arquivo de depuracao invalido: " + filename);
+        }
+        return true;
+    }
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+// Erro registrado durante o processamento. No modo de diagnóstico (-k) os
+// erros são acumulados e o processamento continua na linha seguinte; no modo
+// normal o primeiro erro interrompe a execução com a mesma mensagem.
+struct Diagnostic {
+    int line;             // linha do arquivo de entrada
+    std::string kind;     // "Lexico", "Sintatico", "Semantico" ou "Macro"
+    std::string message;  // mensagem completa, pronta para exibição
+};
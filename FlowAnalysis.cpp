@@ -0,0 +1,443 @@
+#include "FlowAnalysis.hpp"
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+enum Opcode {
+    ADD = 1, SUB = 2, MULT = 3, DIV = 4,
+    JMP = 5, JMPN = 6, JMPP = 7, JMPZ = 8,
+    COPY = 9, LOAD = 10, STORE = 11,
+    INPUT = 12, OUTPUT = 13, STOP = 14
+};
+
+int instructionSize(int opcode) {
+    if (opcode == COPY) return 3;
+    if (opcode == STOP) return 1;
+    return 2;
+}
+
+bool isBranch(int opcode) {
+    return opcode >= JMP && opcode <= JMPZ;
+}
+
+} // namespace
+
+FlowAnalysis::FlowAnalysis(const std::vector<int>& code, const std::vector<char>& opcodeAt,
+                           const std::vector<char>& externalAt, int size)
+    : code(code), opcodeAt(opcodeAt), externalAt(externalAt), labelAt(size + 1), size(size) {}
+
+void FlowAnalysis::setLabel(int address, const std::string& label) {
+    if (address >= 0 && address <= size && labelAt[address].empty()) labelAt[address] = label;
+}
+
+void FlowAnalysis::run() {
+    buildBlocks();
+    markReachable();
+    findLoops();
+    findInputDependence();
+    computePaths();
+}
+
+// Líderes: a primeira instrução, destinos de desvio e a instrução seguinte a
+// um desvio ou STOP. Um bloco também termina onde o código deixa de ser
+// contíguo (dados entre instruções).
+void FlowAnalysis::buildBlocks() {
+    std::vector<int> starts;
+    for (int pos = 0; pos < size; pos++) {
+        if (!opcodeAt[pos]) continue;
+        int opcode = code[pos];
+        if (opcode < ADD || opcode > STOP || pos + instructionSize(opcode) > size) continue;
+        starts.push_back(pos);
+    }
+
+    std::vector<char> isStart(size + 1, 0);
+    for (int pos : starts) isStart[pos] = 1;
+
+    std::vector<char> leader(size + 1, 0);
+    for (size_t i = 0; i < starts.size(); i++) {
+        int pos = starts[i];
+        int opcode = code[pos];
+        if (i == 0 || starts[i - 1] + instructionSize(code[starts[i - 1]]) != pos) leader[pos] = 1;
+        if (isBranch(opcode) || opcode == STOP) {
+            leader[pos + instructionSize(opcode)] = 1;
+        }
+        if (isBranch(opcode) && !externalAt[pos + 1]) {
+            int target = code[pos + 1];
+            if (target >= 0 && target < size && isStart[target]) leader[target] = 1;
+        }
+    }
+
+    blocks.clear();
+    blockAt.assign(size + 1, -1);
+    for (int pos : starts) {
+        if (leader[pos] || blocks.empty()) {
+            Block block;
+            block.start = pos;
+            block.label = labelAt[pos];
+            blockAt[pos] = static_cast<int>(blocks.size());
+            blocks.push_back(block);
+        }
+        Block& block = blocks.back();
+        block.end = pos + instructionSize(code[pos]);
+        block.instructions++;
+        block.lastOpcode = code[pos];
+    }
+
+    for (size_t b = 0; b < blocks.size(); b++) {
+        Block& block = blocks[b];
+        int last = block.end - instructionSize(block.lastOpcode);
+        auto addEdge = [&](int address) {
+            int target = (address >= 0 && address < size) ? blockAt[address] : -1;
+            if (target < 0) {
+                block.leavesCode = true;
+                return;
+            }
+            block.successors.push_back(target);
+            blocks[target].predecessors.push_back(static_cast<int>(b));
+        };
+
+        if (block.lastOpcode == STOP) {
+            block.stops = true;
+        } else if (isBranch(block.lastOpcode)) {
+            if (externalAt[last + 1]) block.leavesCode = true;
+            else addEdge(code[last + 1]);
+            if (!block.successors.empty()) block.branchTarget = block.successors.front();
+            if (block.lastOpcode != JMP) addEdge(block.end);
+        } else {
+            addEdge(block.end);
+        }
+    }
+}
+
+void FlowAnalysis::markReachable() {
+    if (blocks.empty() || blocks[0].start != 0) return;
+    std::vector<int> stack = {0};
+    blocks[0].reachable = true;
+    while (!stack.empty()) {
+        int b = stack.back();
+        stack.pop_back();
+        for (int s : blocks[b].successors) {
+            if (!blocks[s].reachable) {
+                blocks[s].reachable = true;
+                stack.push_back(s);
+            }
+        }
+    }
+}
+
+bool FlowAnalysis::isBackEdge(int from, int to) const {
+    return std::find(backEdges.begin(), backEdges.end(), std::make_pair(from, to)) != backEdges.end();
+}
+
+// Dominadores pelo método iterativo (no máximo ~100 blocos em 216 palavras);
+// uma aresta u -> h com h dominando u fecha um laço natural com cabeçalho h.
+// Arestas de retorno sem essa dominância indicam fluxo irredutível.
+void FlowAnalysis::findLoops() {
+    size_t n = blocks.size();
+    if (n == 0 || !blocks[0].reachable) return;
+
+    std::vector<std::vector<char>> dom(n, std::vector<char>(n, 1));
+    dom[0].assign(n, 0);
+    dom[0][0] = 1;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t b = 1; b < n; b++) {
+            if (!blocks[b].reachable) continue;
+            std::vector<char> next(n, 1);
+            for (int p : blocks[b].predecessors) {
+                if (!blocks[p].reachable) continue;
+                for (size_t i = 0; i < n; i++) next[i] = next[i] && dom[p][i];
+            }
+            next[b] = 1;
+            if (next != dom[b]) {
+                dom[b] = next;
+                changed = true;
+            }
+        }
+    }
+
+    // arestas de retorno na busca em profundidade
+    std::vector<int> state(n, 0); // 0 = novo, 1 = na pilha, 2 = concluído
+    std::function<void(int)> visit = [&](int b) {
+        state[b] = 1;
+        for (int s : blocks[b].successors) {
+            if (state[s] == 0) {
+                visit(s);
+            } else if (state[s] == 1) {
+                if (dom[b][s]) backEdges.push_back({b, s});
+                else irreducibleEdges++;
+            }
+        }
+        state[b] = 2;
+    };
+    visit(0);
+
+    for (const auto& edge : backEdges) {
+        int header = edge.second;
+        std::vector<char> inLoop(n, 0);
+        inLoop[header] = 1;
+        std::vector<int> stack;
+        if (!inLoop[edge.first]) {
+            inLoop[edge.first] = 1;
+            stack.push_back(edge.first);
+        }
+        while (!stack.empty()) {
+            int b = stack.back();
+            stack.pop_back();
+            for (int p : blocks[b].predecessors) {
+                if (blocks[p].reachable && !inLoop[p]) {
+                    inLoop[p] = 1;
+                    stack.push_back(p);
+                }
+            }
+        }
+
+        // laços com o mesmo cabeçalho são unidos
+        auto it = std::find_if(loops.begin(), loops.end(), [&](const Loop& l) { return l.header == header; });
+        if (it == loops.end()) {
+            loops.push_back(Loop());
+            it = loops.end() - 1;
+            it->header = header;
+        }
+        for (size_t b = 0; b < n; b++) {
+            if (inLoop[b] && std::find(it->blocks.begin(), it->blocks.end(), static_cast<int>(b)) == it->blocks.end())
+                it->blocks.push_back(static_cast<int>(b));
+        }
+    }
+
+    for (auto& loop : loops) {
+        std::sort(loop.blocks.begin(), loop.blocks.end());
+        loop.instructions = 0;
+        for (int b : loop.blocks) {
+            loop.instructions += blocks[b].instructions;
+            for (int s : blocks[b].successors) {
+                if (!std::binary_search(loop.blocks.begin(), loop.blocks.end(), s)) loop.hasExit = true;
+            }
+            if (blocks[b].stops || blocks[b].leavesCode) loop.hasExit = true;
+        }
+    }
+    std::sort(loops.begin(), loops.end(), [&](const Loop& a, const Loop& b) { return a.header < b.header; });
+}
+
+// Propagação de "derivado de INPUT": posições de memória (sem distinguir o
+// ponto do programa) e ACC (por bloco, na entrada e na saída). Conservadora:
+// uma posição marcada continua marcada.
+void FlowAnalysis::findInputDependence() {
+    size_t n = blocks.size();
+    std::vector<char> memory(size + 1, 0);
+    std::vector<char> accOut(n, 0);
+    auto tainted = [&](int address) { return address >= 0 && address <= size && memory[address]; };
+    auto taint = [&](int address) {
+        if (address >= 0 && address <= size && !memory[address]) {
+            memory[address] = 1;
+            return true;
+        }
+        return false;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t b = 0; b < n; b++) {
+            Block& block = blocks[b];
+            if (!block.reachable) continue;
+            bool acc = false;
+            for (int p : block.predecessors) acc = acc || accOut[p];
+
+            for (int pos = block.start; pos < block.end; pos += instructionSize(code[pos])) {
+                int opcode = code[pos];
+                int a = pos + 1 < size && !externalAt[pos + 1] ? code[pos + 1] : -1;
+                switch (opcode) {
+                    case INPUT: changed |= taint(a); break;
+                    case LOAD: acc = tainted(a); break;
+                    case ADD: case SUB: case MULT: case DIV: acc = acc || tainted(a); break;
+                    case STORE: if (acc) changed |= taint(a); break;
+                    case COPY: {
+                        int dest = pos + 2 < size && !externalAt[pos + 2] ? code[pos + 2] : -1;
+                        if (tainted(a)) changed |= taint(dest);
+                        break;
+                    }
+                    default: break;
+                }
+            }
+
+            bool conditional = isBranch(block.lastOpcode) && block.lastOpcode != JMP;
+            block.inputBranch = conditional && acc;
+            if (accOut[b] != acc) {
+                accOut[b] = acc;
+                changed = true;
+            }
+        }
+    }
+
+    for (auto& loop : loops) {
+        for (int b : loop.blocks) {
+            if (!blocks[b].inputBranch) continue;
+            for (int s : blocks[b].successors) {
+                if (!std::binary_search(loop.blocks.begin(), loop.blocks.end(), s)) loop.inputDependent = true;
+            }
+        }
+    }
+}
+
+// Sem as arestas de retorno o grafo é acíclico: caminho mais longo e mais
+// curto (em instruções) da entrada até um STOP. No mais longo cada aresta de
+// retorno é tomada uma vez: ao passar por um cabeçalho soma-se uma volta
+// completa do laço (loop.instructions). O mais curto não repete laços.
+void FlowAnalysis::computePaths() {
+    size_t n = blocks.size();
+    if (n == 0 || !blocks[0].reachable) return;
+
+    std::vector<int> order;
+    std::vector<char> visited(n, 0);
+    std::function<void(int)> visit = [&](int b) {
+        visited[b] = 1;
+        for (int s : blocks[b].successors) {
+            if (!visited[s] && !isBackEdge(b, s)) visit(s);
+        }
+        order.push_back(b);
+    };
+    visit(0);
+    std::reverse(order.begin(), order.end());
+
+    // arestas irredutíveis também são ignoradas: só seguem a ordem topológica
+    std::vector<int> rank(n, -1);
+    for (size_t i = 0; i < order.size(); i++) rank[order[i]] = static_cast<int>(i);
+
+    std::vector<int> lap(n, 0);
+    for (const auto& loop : loops) lap[loop.header] = loop.instructions;
+
+    std::vector<int> maxLen(n, -1), minLen(n, -1), maxFrom(n, -1), minFrom(n, -1);
+    maxLen[0] = blocks[0].instructions + lap[0];
+    minLen[0] = blocks[0].instructions;
+    for (int b : order) {
+        if (maxLen[b] < 0) continue;
+        for (int s : blocks[b].successors) {
+            if (rank[s] <= rank[b]) continue;
+            int maxCandidate = maxLen[b] + blocks[s].instructions + lap[s];
+            int minCandidate = minLen[b] + blocks[s].instructions;
+            if (maxCandidate > maxLen[s]) { maxLen[s] = maxCandidate; maxFrom[s] = b; }
+            if (minLen[s] < 0 || minCandidate < minLen[s]) { minLen[s] = minCandidate; minFrom[s] = b; }
+        }
+    }
+
+    auto build = [&](int end, const std::vector<int>& len, const std::vector<int>& from, Path& path) {
+        path.instructions = len[end];
+        path.blocks.clear();
+        for (int b = end; b >= 0; b = from[b]) path.blocks.push_back(b);
+        std::reverse(path.blocks.begin(), path.blocks.end());
+    };
+    for (int b : order) {
+        if (!blocks[b].stops || maxLen[b] < 0) continue;
+        if (maxLen[b] > longest.instructions) build(b, maxLen, maxFrom, longest);
+        if (shortest.instructions < 0 || minLen[b] < shortest.instructions) build(b, minLen, minFrom, shortest);
+    }
+}
+
+std::string FlowAnalysis::blockName(int b) const {
+    std::string name = "B" + std::to_string(b);
+    if (!blocks[b].label.empty()) name += " (" + blocks[b].label + ")";
+    return name;
+}
+
+std::string FlowAnalysis::report() const {
+    std::ostringstream out;
+    int reachable = 0, instructions = 0, words = 0;
+    for (const auto& block : blocks) {
+        if (block.reachable) reachable++;
+        instructions += block.instructions;
+        words += block.end - block.start;
+    }
+
+    out << "Blocos basicos: " << blocks.size() << " (alcancaveis: " << reachable << ")\n";
+    out << "Instrucoes: " << instructions << " em " << words << " palavras de codigo\n";
+    out << "Lacos: " << loops.size();
+    if (irreducibleEdges > 0) out << " (" << irreducibleEdges << " desvio(s) de retorno irredutivel(is))";
+    out << "\n\n";
+
+    out << "=== Blocos ===\n";
+    out << std::left << std::setw(20) << "bloco" << std::right << std::setw(8) << "inicio" << std::setw(6) << "fim"
+        << std::setw(8) << "instr" << "  sucessores\n";
+    for (size_t b = 0; b < blocks.size(); b++) {
+        const Block& block = blocks[b];
+        out << std::left << std::setw(20) << blockName(static_cast<int>(b)) << std::right << std::setw(8) << block.start
+            << std::setw(6) << block.end - 1 << std::setw(8) << block.instructions << " ";
+        for (int s : block.successors) out << " B" << s;
+        if (block.stops) out << " STOP";
+        if (block.leavesCode) out << " ?";
+        if (!block.reachable) out << "  (inalcancavel)";
+        out << "\n";
+    }
+
+    out << "\n=== Lacos ===\n";
+    if (loops.empty()) out << "nenhum\n";
+    for (const auto& loop : loops) {
+        out << "cabecalho " << blockName(loop.header) << ": blocos";
+        for (int b : loop.blocks) out << " B" << b;
+        out << "; " << loop.instructions << " instrucoes por volta";
+        if (!loop.hasExit) out << "; sem saida (laco infinito)";
+        else if (loop.inputDependent) out << "; numero de voltas depende de INPUT";
+        out << "\n";
+    }
+
+    // no caminho mais longo, cada cabeçalho mostra a volta somada
+    auto printPath = [&](const char* title, const Path& path, bool withLaps) {
+        out << title << ": ";
+        if (path.instructions < 0) {
+            out << "nenhum STOP alcancavel\n";
+            return;
+        }
+        out << path.instructions << " instrucoes:";
+        for (size_t i = 0; i < path.blocks.size(); i++) {
+            out << (i ? " -> B" : " B") << path.blocks[i];
+            if (!withLaps) continue;
+            for (const auto& loop : loops) {
+                if (loop.header == path.blocks[i]) out << " (+" << loop.instructions << " da volta)";
+            }
+        }
+        out << "\n";
+    };
+    out << "\n=== Caminhos estaticos ate o STOP ===\n";
+    printPath("mais longo (cada laco da uma volta)", longest, true);
+    printPath("mais curto (sem repetir lacos)", shortest, false);
+    return out.str();
+}
+
+std::string FlowAnalysis::dot(const std::string& name) const {
+    std::ostringstream out;
+    out << "digraph \"" << name << "\" {\n";
+    out << "    node [shape=box, fontname=monospace];\n";
+    std::vector<char> header(blocks.size(), 0);
+    for (const auto& loop : loops) header[loop.header] = 1;
+
+    for (size_t b = 0; b < blocks.size(); b++) {
+        const Block& block = blocks[b];
+        out << "    B" << b << " [label=\"" << blockName(static_cast<int>(b)) << "\\n" << block.start << ".."
+            << block.end - 1 << "  " << block.instructions << " instr\"";
+        if (!block.reachable) out << ", style=dashed, color=gray";
+        else if (header[b]) out << ", style=bold";
+        if (block.stops) out << ", peripheries=2";
+        out << "];\n";
+    }
+    for (size_t b = 0; b < blocks.size(); b++) {
+        const Block& block = blocks[b];
+        bool conditional = isBranch(block.lastOpcode) && block.lastOpcode != JMP;
+        for (size_t i = 0; i < block.successors.size(); i++) {
+            int s = block.successors[i];
+            std::vector<std::string> attributes;
+            if (conditional) attributes.push_back(i == 0 && s == block.branchTarget ? "label=\"sim\"" : "label=\"nao\"");
+            if (isBackEdge(static_cast<int>(b), s)) attributes.push_back("style=dashed");
+            if (block.inputBranch) attributes.push_back("color=red");
+
+            out << "    B" << b << " -> B" << s;
+            for (size_t k = 0; k < attributes.size(); k++) out << (k ? ", " : " [") << attributes[k];
+            out << (attributes.empty() ? ";\n" : "];\n");
+        }
+    }
+    out << "}\n";
+    return out.str();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Análise estática do código montado (depois da resolução das pendências):
+// blocos básicos, grafo de fluxo de controle, laços naturais, caminhos
+// estáticos e laços cuja saída depende de valores lidos por INPUT.
+// Serve para comparar versões do código gerado sem simulá-las.
+class FlowAnalysis {
+public:
+    struct Block {
+        int start;                     // endereço da primeira instrução
+        int end;                       // endereço seguinte à última palavra
+        int instructions = 0;
+        int lastOpcode = 0;
+        std::string label;             // rótulo no início do bloco, se houver
+        std::vector<int> successors;   // desvio primeiro, depois a sequência
+        int branchTarget = -1;         // bloco destino do desvio, se válido
+        std::vector<int> predecessors;
+        bool reachable = false;
+        bool stops = false;            // termina em STOP
+        bool leavesCode = false;       // desvio externo/inválido ou cai em dados
+        bool inputBranch = false;      // desvio condicional sobre ACC derivado de INPUT
+    };
+
+    struct Loop {
+        int header;
+        std::vector<int> blocks;       // ordenados
+        int instructions = 0;          // instruções de uma volta completa pelo corpo
+        bool hasExit = false;
+        bool inputDependent = false;   // alguma saída testa valor derivado de INPUT
+    };
+
+    struct Path {
+        int instructions = -1;         // -1: nenhum caminho até um STOP
+        std::vector<int> blocks;
+    };
+
+private:
+    const std::vector<int>& code;
+    std::vector<char> opcodeAt;        // 1 = início de instrução
+    std::vector<char> externalAt;      // 1 = operando EXTERN (resolvido pelo ligador)
+    std::vector<std::string> labelAt;
+    int size;
+
+    std::vector<Block> blocks;
+    std::vector<int> blockAt;          // endereço -> bloco que começa nele (-1)
+    std::vector<Loop> loops;
+    std::vector<std::pair<int, int>> backEdges;
+    int irreducibleEdges = 0;
+    Path longest;                      // cada laço no caminho dá uma volta completa
+    Path shortest;                     // nenhuma aresta de retorno
+
+    void buildBlocks();
+    void markReachable();
+    void findLoops();
+    void computePaths();
+    void findInputDependence();
+    std::string blockName(int b) const;
+    bool isBackEdge(int from, int to) const;
+
+public:
+    FlowAnalysis(const std::vector<int>& code, const std::vector<char>& opcodeAt,
+                 const std::vector<char>& externalAt, int size);
+
+    // nomeia o bloco que começar em address (o primeiro rótulo registrado vale)
+    void setLabel(int address, const std::string& label);
+    void run();
+
+    const std::vector<Block>& getBlocks() const { return blocks; }
+    const std::vector<Loop>& getLoops() const { return loops; }
+
+    std::string report() const;
+    std::string dot(const std::string& name) const;
+};
@@ -0,0 +1,140 @@
+#include "Linker.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+template <typename Job>
+void Linker::parallelFor(size_t count, Job job) {
+    size_t workers = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic<size_t> next(0);
+    std::vector<std::exception_ptr> errors(count);
+    std::vector<std::thread> threads;
+
+    for (size_t w = 0; w < workers; ++w) {
+        threads.emplace_back([&]() {
+            size_t i;
+            while ((i = next++) < count) {
+                try {
+                    job(i);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    // reporta o erro do primeiro módulo, independente da ordem das threads
+    for (auto& e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+}
+
+ObjectModule Linker::readObject(const std::string& filename) {
+    std::ifstream fin(filename);
+    if (!fin.is_open()) throw std::runtime_error("Unable to open object file: " + filename);
+
+    ObjectModule module;
+    int size = -1;
+    bool hasCode = false;
+    std::string line;
+    while (std::getline(fin, line)) {
+        if (line.empty()) continue;
+        std::istringstream ss(line);
+        std::string tag;
+        ss >> tag;
+
+        if (tag == "H:") {
+            if (module.name.empty()) ss >> module.name;
+            else ss >> size;
+        } else if (tag == "D:") {
+            std::string label;
+            int address;
+            ss >> label >> address;
+            module.definitions.push_back({label, address});
+        } else if (tag == "U:") {
+            ObjectModule::Use use;
+            ss >> use.label >> use.position >> use.offset;
+            module.uses.push_back(use);
+        } else if (tag == "R:") {
+            int bit;
+            while (ss >> bit) module.relocatable.push_back(static_cast<char>(bit));
+        } else if (tag == "T:") {
+            int word;
+            while (ss >> word) module.code.push_back(word);
+            hasCode = true;
+        } else {
+            throw std::runtime_error("Invalid record '" + tag + "' in " + filename);
+        }
+        if (ss.fail() && !ss.eof()) throw std::runtime_error("Invalid record '" + line + "' in " + filename);
+    }
+
+    if (module.name.empty() || !hasCode || size != static_cast<int>(module.code.size()) ||
+        module.relocatable.size() != module.code.size())
+        throw std::runtime_error("Malformed object file: " + filename);
+    for (const auto& use : module.uses) {
+        if (use.position < 0 || use.position >= size)
+            throw std::runtime_error("Invalid use of '" + use.label + "' in " + filename);
+    }
+    return module;
+}
+
+void Linker::load(const std::vector<std::string>& objectFiles) {
+    modules.assign(objectFiles.size(), ObjectModule());
+    parallelFor(objectFiles.size(), [&](size_t i) { modules[i] = readObject(objectFiles[i]); });
+}
+
+void Linker::relocate(const ObjectModule& module) {
+    for (size_t i = 0; i < module.code.size(); ++i) {
+        int word = module.code[i];
+        if (module.relocatable[i]) word += module.base;
+        image[module.base + i] = word;
+    }
+    for (const auto& use : module.uses) {
+        auto it = globalSymbols.find(use.label);
+        if (it == globalSymbols.end())
+            throw std::runtime_error("Undefined symbol '" + use.label + "' used in module " + module.name);
+        image[module.base + use.position] = it->second + use.offset;
+    }
+}
+
+void Linker::link() {
+    // bases: módulos na ordem da linha de comando
+    int size = 0;
+    for (auto& module : modules) {
+        module.base = size;
+        size += static_cast<int>(module.code.size());
+    }
+    if (size > MEMORY_SIZE)
+        throw std::runtime_error("Linked program has " + std::to_string(size) + " words and does not fit in memory (" +
+                                 std::to_string(MEMORY_SIZE) + ")");
+
+    globalSymbols.clear();
+    for (const auto& module : modules) {
+        for (const auto& def : module.definitions) {
+            if (!globalSymbols.insert({def.first, module.base + def.second}).second)
+                throw std::runtime_error("Symbol '" + def.first + "' defined in more than one module");
+        }
+    }
+
+    // cada módulo escreve só no seu intervalo da imagem
+    image.assign(size, 0);
+    parallelFor(modules.size(), [&](size_t i) { relocate(modules[i]); });
+}
+
+void Linker::write(const std::string& outputFile) const {
+    std::ofstream fout(outputFile);
+    if (!fout.is_open()) throw std::runtime_error("Unable to create output file: " + outputFile);
+
+    for (size_t i = 0; i < image.size(); ++i) {
+        fout << image[i];
+        if (i + 1 < image.size()) fout << " ";
+    }
+    fout << "\n";
+    std::cerr << "Linking finished. Output: " << outputFile << "\n";
+}
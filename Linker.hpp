@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Objeto relocável gerado por "compilador <arquivo> obj"
+struct ObjectModule {
+    struct Use {
+        std::string label;
+        int position;
+        int offset;
+    };
+
+    std::string name;
+    std::vector<std::pair<std::string, int>> definitions; // PUBLIC: rótulo e endereço relativo
+    std::vector<Use> uses;                                // EXTERN: uma entrada por referência
+    std::vector<char> relocatable;                         // 1 = palavra é endereço relativo
+    std::vector<int> code;
+    int base = 0;                                          // endereço do módulo na imagem final
+};
+
+// Ligador: lê os objetos em paralelo, calcula a base de cada módulo,
+// monta a tabela global de definições e reloca cada módulo em paralelo.
+class Linker {
+private:
+    std::vector<ObjectModule> modules;
+    std::unordered_map<std::string, int> globalSymbols; // rótulo -> endereço absoluto
+    std::vector<int> image;
+
+    static ObjectModule readObject(const std::string& filename);
+    void relocate(const ObjectModule& module);
+
+    // executa job(i) para i em [0, count) distribuído entre as threads
+    template <typename Job>
+    static void parallelFor(size_t count, Job job);
+
+public:
+    static const int MEMORY_SIZE = 216;
+
+    void load(const std::vector<std::string>& objectFiles);
+    void link();
+    void write(const std::string& outputFile) const;
+};
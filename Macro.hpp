@@ -2,9 +2,13 @@
 
 #include <string>
 #include <vector>
+#include "SymbolPool.hpp"
 
 struct Macro {
-    std::string name; // macro name, uppercase
-    std::vector<std::string> args; // formal args, uppercase (max 2)
+    SymbolId name = SymbolPool::NONE; // macro name, uppercase (interned)
+    std::vector<SymbolId> args; // formal args, uppercase, interned (max 2)
     std::vector<std::string> body; // body lines (already normalized to uppercase)
-};
\ No newline at end of file
+    int line = 0; // line of the definition in the .asm
+    std::vector<int> bodyLines; // .asm line of each body line
+    bool fromLibrary = false; // loaded with INCLUDE (not counted in the 2-macro limit)
+};
@@ -0,0 +1,189 @@
+#include "MacroCache.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+const char MAGIC[4] = {'S', 'B', 'M', 'C'};
+const std::uint32_t VERSION = 1;
+
+struct Stamp {
+    std::uint64_t size = 0;
+    std::int64_t mtime = 0;
+    std::uint64_t hash = 0;
+};
+
+bool statLibrary(const std::string& library, Stamp& stamp) {
+    struct stat st;
+    if (::stat(library.c_str(), &st) != 0) return false;
+    stamp.size = static_cast<std::uint64_t>(st.st_size);
+    stamp.mtime = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+bool hashLibrary(const std::string& library, std::uint64_t& hash) {
+    std::ifstream fin(library, std::ios::binary);
+    if (!fin.is_open()) return false;
+    hash = 14695981039346656037ull; // FNV-1a 64
+    char buffer[1 << 14];
+    while (fin.read(buffer, sizeof(buffer)) || fin.gcount() > 0) {
+        for (std::streamsize i = 0; i < fin.gcount(); ++i) {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 1099511628211ull;
+        }
+    }
+    return true;
+}
+
+// leitura com verificação de limites sobre o arquivo mapeado
+class Reader {
+private:
+    const char* pos;
+    const char* end;
+
+public:
+    Reader(const char* data, size_t size) : pos(data), end(data + size) {}
+
+    template <typename T>
+    bool read(T& value) {
+        if (static_cast<size_t>(end - pos) < sizeof(T)) return false;
+        std::memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    bool read(std::string_view& text) {
+        std::uint32_t length;
+        if (!read(length) || static_cast<size_t>(end - pos) < length) return false;
+        text = std::string_view(pos, length);
+        pos += length;
+        return true;
+    }
+
+    bool atEnd() const { return pos == end; }
+};
+
+template <typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void put(std::string& out, std::string_view text) {
+    put(out, static_cast<std::uint32_t>(text.size()));
+    out.append(text.data(), text.size());
+}
+
+bool decode(Reader& in, SymbolPool& symbols, std::vector<Macro>& macros) {
+    std::uint32_t count;
+    if (!in.read(count)) return false;
+    std::vector<Macro> decoded(count);
+    for (auto& m : decoded) {
+        std::string_view text;
+        std::uint32_t n;
+        if (!in.read(text)) return false;
+        m.name = symbols.intern(text);
+        if (!in.read(n)) return false;
+        for (std::uint32_t i = 0; i < n; ++i) {
+            if (!in.read(text)) return false;
+            m.args.push_back(symbols.intern(text));
+        }
+        if (!in.read(n)) return false;
+        for (std::uint32_t i = 0; i < n; ++i) {
+            if (!in.read(text)) return false;
+            m.body.emplace_back(text);
+        }
+    }
+    if (!in.atEnd()) return false;
+    macros = std::move(decoded);
+    return true;
+}
+
+} // namespace
+
+// nome completo + .mcache: lib.mac e lib.asm no mesmo diretório têm caches distintos
+std::string MacroCache::cachePath(const std::string& library) {
+    return library + ".mcache";
+}
+
+bool MacroCache::load(const std::string& library, SymbolPool& symbols, std::vector<Macro>& macros) {
+    Stamp current;
+    if (!statLibrary(library, current)) return false;
+
+    int fd = ::open(cachePath(library).c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) return false;
+
+    Reader in(static_cast<const char*>(data), size);
+    char magic[4];
+    std::uint32_t version = 0;
+    Stamp cached;
+    bool valid = in.read(magic) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 && in.read(version) &&
+                 version == VERSION && in.read(cached.size) && in.read(cached.mtime) && in.read(cached.hash) &&
+                 cached.size == current.size;
+
+    // mtime diferente: o arquivo pode ter sido só tocado, o conteúdo decide
+    bool refresh = false;
+    if (valid && cached.mtime != current.mtime) {
+        valid = hashLibrary(library, current.hash) && current.hash == cached.hash;
+        refresh = valid;
+    }
+    if (valid) valid = decode(in, symbols, macros);
+    ::munmap(data, size);
+
+    if (refresh) store(library, symbols, macros);
+    return valid;
+}
+
+void MacroCache::store(const std::string& library, const SymbolPool& symbols, const std::vector<Macro>& macros) {
+    Stamp stamp;
+    if (!statLibrary(library, stamp) || !hashLibrary(library, stamp.hash)) return;
+
+    std::string out;
+    out.append(MAGIC, sizeof(MAGIC));
+    put(out, VERSION);
+    put(out, stamp.size);
+    put(out, stamp.mtime);
+    put(out, stamp.hash);
+    put(out, static_cast<std::uint32_t>(macros.size()));
+    for (const auto& m : macros) {
+        put(out, symbols.name(m.name));
+        put(out, static_cast<std::uint32_t>(m.args.size()));
+        for (SymbolId arg : m.args) put(out, symbols.name(arg));
+        put(out, static_cast<std::uint32_t>(m.body.size()));
+        for (const auto& line : m.body) put(out, std::string_view(line));
+    }
+
+    // grava num temporário e renomeia, para que leitores concorrentes
+    // (threads do servidor) nunca vejam um cache pela metade
+    std::ostringstream tmpName;
+    tmpName << cachePath(library) << ".tmp." << ::getpid() << "." << std::hash<std::thread::id>()(std::this_thread::get_id());
+    std::string tmp = tmpName.str();
+    {
+        std::ofstream fout(tmp, std::ios::binary | std::ios::trunc);
+        if (!fout.is_open()) return;
+        fout.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!fout) {
+            fout.close();
+            std::remove(tmp.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmp.c_str(), cachePath(library).c_str()) != 0) std::remove(tmp.c_str());
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Macro.hpp"
+#include "SymbolPool.hpp"
+
+// Cache binário das macros de uma biblioteca incluída com INCLUDE, gravado
+// ao lado dela como <biblioteca>.mcache (ex.: util.mac.mcache). Guarda as definições já
+// normalizadas, então uma biblioteca inalterada não é relida nem reanalisada.
+//
+// Formato (inteiros em ordem nativa, strings = u32 tamanho + bytes):
+//   "SBMC" u32 versão
+//   u64 tamanho  i64 mtime (ns)  u64 hash FNV-1a do conteúdo
+//   u32 n  e, para cada macro: nome, u32 nargs, args..., u32 nlinhas, linhas...
+//
+// O cache vale se tamanho e mtime baterem com a biblioteca; se só o mtime
+// mudou, o hash do conteúdo decide (e o cache é regravado com o novo mtime).
+class MacroCache {
+public:
+    static std::string cachePath(const std::string& library);
+
+    // carrega as macros do cache via mmap; false se ausente, corrompido ou desatualizado
+    static bool load(const std::string& library, SymbolPool& symbols, std::vector<Macro>& macros);
+
+    // grava o cache (falhas de escrita são ignoradas: o cache é só uma otimização)
+    static void store(const std::string& library, const SymbolPool& symbols, const std::vector<Macro>& macros);
+};
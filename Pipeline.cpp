@@ -0,0 +1,281 @@
+#include "Pipeline.hpp"
+#include "Preprocessor.hpp"
+#include "Assembler.hpp"
+#include "SpscRing.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Espera ativa (com yield) enquanto a fila de saída está cheia; false se o
+// pipeline foi abortado antes de haver espaço
+template <typename T>
+bool pushWait(SpscRing<T>& ring, T& item, Pipeline::StageStats& stats, const std::atomic<bool>& abort) {
+    if (ring.tryPush(item)) return true;
+    ++stats.outputStalls;
+    Clock::time_point start = Clock::now();
+    bool pushed = true;
+    while (!ring.tryPush(item)) {
+        if (abort.load(std::memory_order_acquire)) {
+            pushed = false;
+            break;
+        }
+        std::this_thread::yield();
+    }
+    stats.waitSeconds += secondsSince(start);
+    return pushed;
+}
+
+// Espera enquanto a fila de entrada está vazia; false quando o produtor a
+// fechou e ela esvaziou, ou se o pipeline foi abortado
+template <typename T>
+bool popWait(SpscRing<T>& ring, T& item, Pipeline::StageStats& stats, const std::atomic<bool>& abort) {
+    if (ring.tryPop(item)) return true;
+    // close() vem depois do último push: reler a fila depois de vê-la fechada
+    if (ring.isClosed()) return ring.tryPop(item);
+    ++stats.inputStalls;
+    Clock::time_point start = Clock::now();
+    bool popped = false;
+    while (true) {
+        if (ring.tryPop(item)) {
+            popped = true;
+            break;
+        }
+        if (ring.isClosed()) {
+            popped = ring.tryPop(item);
+            break;
+        }
+        if (abort.load(std::memory_order_acquire)) break;
+        std::this_thread::yield();
+    }
+    stats.waitSeconds += secondsSince(start);
+    return popped;
+}
+
+} // namespace
+
+Pipeline::Pipeline(Preprocessor& pre, Assembler& assembler) : pre(pre), assembler(assembler) {
+    resetStats();
+}
+
+void Pipeline::resetStats() {
+    static const char* names[3] = {"leitura", "preprocessador", "montador"};
+    for (int i = 0; i < 3; ++i) {
+        stats[i] = StageStats();
+        stats[i].name = names[i];
+    }
+    wallSeconds = 0;
+}
+
+// Divide text em linhas como getline: '\n' termina a linha e a última pode
+// não ter terminador
+Pipeline::BatchPtr Pipeline::makeBatch(std::string text) {
+    BatchPtr batch = std::make_unique<LineBatch>();
+    batch->text = std::move(text);
+    const std::string& t = batch->text;
+    size_t start = 0;
+    for (size_t end = t.find('\n'); end != std::string::npos; end = t.find('\n', start)) {
+        batch->lines.emplace_back(t.data() + start, end - start);
+        start = end + 1;
+    }
+    if (start < t.size()) batch->lines.emplace_back(t.data() + start, t.size() - start);
+    return batch;
+}
+
+// Lê blocos de batchBytes e corta no último '\n'; o resto (linha incompleta)
+// fica em carry para o próximo lote
+Pipeline::BatchPtr Pipeline::readBatch(std::istream& in, std::string& carry) {
+    std::string text = std::move(carry);
+    carry.clear();
+    while (in) {
+        size_t used = text.size();
+        text.resize(used + batchBytes);
+        in.read(&text[used], static_cast<std::streamsize>(batchBytes));
+        text.resize(used + static_cast<size_t>(in.gcount()));
+        if (!in) break; // fim do arquivo: o que sobrou é a última linha
+
+        size_t cut = text.rfind('\n');
+        if (cut == std::string::npos) continue; // linha maior que o bloco
+        carry.assign(text, cut + 1, std::string::npos);
+        text.resize(cut + 1);
+        return makeBatch(std::move(text));
+    }
+    if (text.empty()) return nullptr;
+    return makeBatch(std::move(text));
+}
+
+// O .pre de um lote do .asm; cada linha emitida termina em '\n', então os
+// lotes de saída também só têm linhas completas
+Pipeline::BatchPtr Pipeline::preprocessBatch(const LineBatch& batch) {
+    std::ostringstream out;
+    std::string line;
+    for (std::string_view view : batch.lines) {
+        line.assign(view.data(), view.size());
+        pre.feedLine(line, out);
+    }
+    return makeBatch(out.str());
+}
+
+void Pipeline::finishAssembly(std::exception_ptr asmError) {
+    // -k: os erros do Preprocessor são relatados pelo chamador e o .pre
+    // incompleto não é montado, como na execução separada
+    if (!pre.getDiagnostics().empty()) return;
+    if (asmError) std::rethrow_exception(asmError);
+
+    Clock::time_point start = Clock::now();
+    assembler.finish();
+    double elapsed = secondsSince(start);
+    stats[2].busySeconds += elapsed;
+    wallSeconds += elapsed;
+}
+
+void Pipeline::run(std::istream& in) {
+    resetStats();
+    pre.begin();
+    Clock::time_point wallStart = Clock::now();
+
+    SpscRing<BatchPtr> readQueue(queueBatches);
+    SpscRing<BatchPtr> preQueue(queueBatches);
+    std::atomic<bool> abort{false};
+    std::exception_ptr readError, preError, asmError;
+
+    std::thread reader([&] {
+        StageStats& st = stats[0];
+        try {
+            std::string carry;
+            while (!abort.load(std::memory_order_acquire)) {
+                Clock::time_point start = Clock::now();
+                BatchPtr batch = readBatch(in, carry);
+                st.busySeconds += secondsSince(start);
+                if (!batch) break;
+                st.lines += batch->lines.size();
+                ++st.batches;
+                if (!pushWait(readQueue, batch, st, abort)) break;
+            }
+        } catch (...) {
+            readError = std::current_exception();
+            abort.store(true, std::memory_order_release);
+        }
+        readQueue.close();
+    });
+
+    std::thread preprocessor([&] {
+        StageStats& st = stats[1];
+        try {
+            BatchPtr batch;
+            while (popWait(readQueue, batch, st, abort)) {
+                Clock::time_point start = Clock::now();
+                BatchPtr output = preprocessBatch(*batch);
+                st.busySeconds += secondsSince(start);
+                st.lines += batch->lines.size();
+                ++st.batches;
+                if (!pushWait(preQueue, output, st, abort)) break;
+            }
+            if (!abort.load(std::memory_order_acquire)) pre.finish();
+        } catch (...) {
+            preError = std::current_exception();
+            abort.store(true, std::memory_order_release);
+        }
+        preQueue.close();
+    });
+
+    // Montagem na thread atual. Depois de um erro do Assembler os lotes
+    // seguintes só são descartados: um erro posterior do Preprocessor ainda
+    // tem precedência
+    StageStats& st = stats[2];
+    BatchPtr batch;
+    while (popWait(preQueue, batch, st, abort)) {
+        if (asmError) continue;
+        Clock::time_point start = Clock::now();
+        try {
+            for (std::string_view line : batch->lines) {
+                assembler.feedLine(line);
+            }
+        } catch (...) {
+            asmError = std::current_exception();
+        }
+        st.busySeconds += secondsSince(start);
+        st.lines += batch->lines.size();
+        ++st.batches;
+    }
+
+    reader.join();
+    preprocessor.join();
+    wallSeconds = secondsSince(wallStart);
+
+    if (readError) std::rethrow_exception(readError);
+    if (preError) std::rethrow_exception(preError);
+    finishAssembly(asmError);
+}
+
+void Pipeline::runSerial(std::istream& in) {
+    resetStats();
+    pre.begin();
+    Clock::time_point wallStart = Clock::now();
+
+    std::exception_ptr asmError;
+    std::string carry;
+    while (true) {
+        Clock::time_point start = Clock::now();
+        BatchPtr batch = readBatch(in, carry);
+        stats[0].busySeconds += secondsSince(start);
+        if (!batch) break;
+        stats[0].lines += batch->lines.size();
+        ++stats[0].batches;
+
+        start = Clock::now();
+        BatchPtr output = preprocessBatch(*batch);
+        stats[1].busySeconds += secondsSince(start);
+        stats[1].lines += batch->lines.size();
+        ++stats[1].batches;
+
+        if (asmError) continue;
+        start = Clock::now();
+        try {
+            for (std::string_view line : output->lines) {
+                assembler.feedLine(line);
+            }
+        } catch (...) {
+            asmError = std::current_exception();
+        }
+        stats[2].busySeconds += secondsSince(start);
+        stats[2].lines += output->lines.size();
+        ++stats[2].batches;
+    }
+    pre.finish();
+    wallSeconds = secondsSince(wallStart);
+
+    finishAssembly(asmError);
+}
+
+std::string Pipeline::formatStats() const {
+    std::ostringstream out;
+    out << std::left << std::setw(16) << "etapa" << std::right
+        << std::setw(10) << "linhas" << std::setw(8) << "lotes"
+        << std::setw(13) << "ocupado(ms)" << std::setw(12) << "espera(ms)"
+        << std::setw(12) << "linhas/s" << std::setw(14) << "esperas(ent)"
+        << std::setw(14) << "esperas(sai)" << "\n";
+    out << std::fixed;
+    for (const StageStats& st : stats) {
+        double rate = st.busySeconds > 0 ? st.lines / st.busySeconds : 0;
+        out << std::left << std::setw(16) << st.name << std::right
+            << std::setw(10) << st.lines << std::setw(8) << st.batches
+            << std::setw(13) << std::setprecision(3) << st.busySeconds * 1000
+            << std::setw(12) << std::setprecision(3) << st.waitSeconds * 1000
+            << std::setw(12) << std::setprecision(0) << rate
+            << std::setw(14) << st.inputStalls << std::setw(14) << st.outputStalls << "\n";
+    }
+    out << "total: " << std::setprecision(3) << wallSeconds * 1000 << " ms\n";
+    return out.str();
+}
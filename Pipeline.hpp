@@ -0,0 +1,72 @@
+#pragma once
+
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Preprocessor;
+class Assembler;
+
+// Pré-processamento e montagem de um .asm num único processo, em três
+// etapas: leitura do arquivo, Preprocessor (normalização e expansão de
+// macros) e Assembler. No modo em pipeline cada etapa roda na sua thread,
+// ligadas por filas SPSC sem travas que carregam lotes de linhas; o
+// resultado é o mesmo da execução serial das etapas.
+//
+// Preprocessor e Assembler não podem compartilhar uma SymbolPool: no modo em
+// pipeline eles a usariam ao mesmo tempo a partir de threads diferentes.
+//
+// Um erro do Preprocessor tem precedência sobre um do Assembler, como na
+// execução separada (preprocessor e depois compilador).
+class Pipeline {
+public:
+    struct StageStats {
+        std::string name;
+        unsigned long long lines = 0;
+        unsigned long long batches = 0;
+        unsigned long long inputStalls = 0;   // esperas por fila de entrada vazia
+        unsigned long long outputStalls = 0;  // esperas por fila de saída cheia
+        double busySeconds = 0;
+        double waitSeconds = 0;
+    };
+
+private:
+    // texto de várias linhas completas; as views apontam para text
+    struct LineBatch {
+        std::string text;
+        std::vector<std::string_view> lines;
+    };
+    using BatchPtr = std::unique_ptr<LineBatch>;
+
+    Preprocessor& pre;
+    Assembler& assembler;
+    size_t batchBytes = 64 * 1024;
+    size_t queueBatches = 16;
+    StageStats stats[3];
+    double wallSeconds = 0;
+
+    static BatchPtr makeBatch(std::string text);
+    // lê o próximo bloco de linhas completas; nullptr no fim da entrada
+    BatchPtr readBatch(std::istream& in, std::string& carry);
+    BatchPtr preprocessBatch(const LineBatch& batch);
+    // precedência dos erros e verificações finais do Assembler
+    void finishAssembly(std::exception_ptr asmError);
+    void resetStats();
+
+public:
+    Pipeline(Preprocessor& pre, Assembler& assembler);
+
+    void setBatchBytes(size_t bytes) { batchBytes = bytes == 0 ? 1 : bytes; }
+    void setQueueCapacity(size_t batches) { queueBatches = batches == 0 ? 1 : batches; }
+
+    // leitura, pré-processamento e montagem em três threads
+    void run(std::istream& in);
+    // as mesmas etapas e lotes, em sequência na thread atual
+    void runSerial(std::istream& in);
+
+    const StageStats* getStats() const { return stats; }
+    std::string formatStats() const;
+};
@@ -1,10 +1,16 @@
 #include "Preprocessor.hpp"
+#include "MacroCache.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <exception>
 #include <sstream>
 #include <stdexcept>
 #include <iostream>
 #include <fstream> 
+#include <thread>
+#include <climits>
+#include <cstdlib>
 static bool isIdentChar(char c) {
     return (std::isalnum(static_cast<unsigned char>(c)) || c == '_');
 }
@@ -56,104 +62,251 @@ std::vector<std::string> Preprocessor::splitArgs(const std::string& s) {
     return parts;
 }
 
-void Preprocessor::storeMacro(std::ifstream& fin, const std::string& firstLineRaw) {
-    
-    // limite de 2 macros
-    if (macros.size() >= 2) {
-        throw std::runtime_error("Erro: Mais de 2 macros definidas no programa (Limite da especificacao).");
+// remove o comentário, passa para maiúsculas e normaliza os espaços
+std::string Preprocessor::normalizeLine(const std::string& rawLine) {
+    size_t commentPos = rawLine.find(';');
+    std::string noComment = commentPos != std::string::npos ? rawLine.substr(0, commentPos) : rawLine;
+    std::string normalized = toUpper(trim(noComment));
+    if (normalized.empty()) return normalized;
+    return collapseSpaces(normalized);
+}
+
+// equivalente a normalizeLine(rawLine).find("MACRO") != npos, sem copiar a linha
+bool Preprocessor::mentionsMacro(const std::string& rawLine) {
+    static const char keyword[] = "MACRO";
+    size_t end = std::min(rawLine.find(';'), rawLine.size());
+    for (size_t i = 0; i + 5 <= end; ++i) {
+        size_t k = 0;
+        while (k < 5 && std::toupper(static_cast<unsigned char>(rawLine[i + k])) == keyword[k]) ++k;
+        if (k == 5) return true;
+    }
+    return false;
+}
+
+// INCLUDE <arquivo> ou INCLUDE "arquivo"; o caminho mantém as maiúsculas/minúsculas
+bool Preprocessor::isInclude(const std::string& rawLine, std::string& path) {
+    static const char keyword[] = "INCLUDE";
+    std::string line = trim(rawLine.substr(0, rawLine.find(';')));
+    if (line.size() <= 7) return false;
+    for (size_t k = 0; k < 7; ++k) {
+        if (std::toupper(static_cast<unsigned char>(line[k])) != keyword[k]) return false;
+    }
+    if (line[7] != ' ' && line[7] != '\t') return false;
+    path = trim(line.substr(7));
+    if (path.size() >= 2 && path.front() == '"' && path.back() == '"') path = path.substr(1, path.size() - 2);
+    return !path.empty();
+}
+
+void Preprocessor::reportError(int line, const std::string& message) {
+    diagnostics.push_back({line, "Macro", message});
+}
+
+// Cabeçalho "NOME: MACRO [args]". Erros no cabeçalho não interrompem a
+// leitura no modo -k: o corpo é consumido até o ENDMACRO para que o
+// processamento continue depois da definição
+bool Preprocessor::beginMacro(const std::string& firstLineRaw) {
+    int headerLine = inputLine;
+    Macro m;
+    m.line = headerLine;
+    std::string error;
+
+    // limite de 2 macros (as de bibliotecas não contam)
+    size_t defined = std::count_if(macros.begin(), macros.end(), [](const Macro& other) { return !other.fromLibrary; });
+    if (!parsingLibrary && defined >= 2) {
+        error = "Erro: Mais de 2 macros definidas no programa (Limite da especificacao).";
     }
 
     std::string firstLine = toUpper(trim(firstLineRaw));
 
     // Parse do cabeçalho da macro: NOME: MACRO [args]
     size_t colon = firstLine.find(':');
-    if (colon == std::string::npos) {
-        throw std::runtime_error("Erro: Definicao de macro deve usar 'LABEL: MACRO ...'");
+    size_t macroPos = std::string::npos;
+    if (error.empty() && colon == std::string::npos) {
+        error = "Erro: Definicao de macro deve usar 'LABEL: MACRO ...'";
     }
-    std::string name = trim(firstLine.substr(0, colon));
-    size_t macroPos = firstLine.find("MACRO", colon);
-    if (macroPos == std::string::npos) {
-        throw std::runtime_error("Erro: Linha de definicao de macro nao contem 'MACRO'.");
+    if (error.empty()) {
+        m.name = symbols->intern(trim(firstLine.substr(0, colon)));
+        macroPos = firstLine.find("MACRO", colon);
+        if (macroPos == std::string::npos) {
+            error = "Erro: Linha de definicao de macro nao contem 'MACRO'.";
+        }
     }
 
-    Macro m;
-    m.name = name;
-
     // Parse dos argumentos
-    std::string argsPart = trim(firstLine.substr(macroPos + 5)); // após "MACRO"
-    if (!argsPart.empty()) {
-        auto parts = splitArgs(argsPart);
-        for (auto& p : parts) {
-            std::string up = toUpper(p);
-            // Remove &, se presente.
-            if (!up.empty() && up[0] == '&') {
-                up.erase(0, 1);
+    if (error.empty()) {
+        std::string argsPart = trim(firstLine.substr(macroPos + 5)); // após "MACRO"
+        if (!argsPart.empty()) {
+            auto parts = splitArgs(argsPart);
+            for (auto& p : parts) {
+                std::string up = toUpper(p);
+                // Remove &, se presente.
+                if (!up.empty() && up[0] == '&') {
+                    up.erase(0, 1);
+                }
+                up = trim(up);
+                m.args.push_back(symbols->intern(up));
             }
-            up = trim(up);
-            m.args.push_back(up);
+        }
+
+        // verifica quantidade de args
+        if (m.args.size() > 2) {
+            error = "Erro: Macro '" + symbols->str(m.name) + "' definida com mais de 2 argumentos (Limite da especificacao).";
         }
     }
 
-    // verifica quantidade de args
-    if (m.args.size() > 2) {
-        throw std::runtime_error("Erro: Macro '" + m.name + "' definida com mais de 2 argumentos (Limite da especificacao).");
+    if (!error.empty()) {
+        reportError(headerLine, error);
+        if (!keepGoing) return false;
     }
 
-    // Leitura do corpo da macro
+    inMacro = true;
+    pendingMacro = std::move(m);
+    pendingError = error;
+    return true;
+}
+
+// Linha do corpo da definição em andamento; o ENDMACRO conclui a definição
+void Preprocessor::addMacroLine(const std::string& rawLine) {
+    // remove comentarios e normaliza espaçamento
+    std::string norm = normalizeLine(rawLine);
+    if (norm.empty()) return; // Pula linhas em branco
+
+    // Verifica o fim da macro
+    if (norm == "ENDMACRO") {
+        endMacro();
+        return;
+    }
+
+    pendingMacro.body.push_back(norm);
+    pendingMacro.bodyLines.push_back(inputLine);
+}
+
+// Armazena a macro finalizada no vetor (sem ENDMACRO, no fim do arquivo)
+void Preprocessor::endMacro() {
+    inMacro = false;
+    if (pendingError.empty()) macros.push_back(std::move(pendingMacro));
+    pendingMacro = Macro();
+    pendingError.clear();
+}
+
+void Preprocessor::storeMacro(std::istream& fin, const std::string& firstLine) {
+    if (!beginMacro(firstLine)) return;
+
     std::string line;
-    while (std::getline(fin, line)) {
-        
-        // remove comentarios da macro
-        std::string noComment;
-        size_t commentPos = line.find(';'); // Procura o ';' na linha crua
-        if (commentPos != std::string::npos) {
-            noComment = line.substr(0, commentPos); // Pega só a parte antes
-        } else {
-            noComment = line; // Linha inteira
+    while (inMacro && std::getline(fin, line)) {
+        ++inputLine;
+        addMacroLine(line);
+    }
+    if (inMacro) endMacro();
+}
+
+// Biblioteca: só definições de macro, sem limite de quantidade. Os erros
+// interrompem a leitura e são reportados na linha do INCLUDE.
+void Preprocessor::parseLibrary(std::istream& fin) {
+    parsingLibrary = true;
+    std::string rawLine;
+    while (std::getline(fin, rawLine)) {
+        ++inputLine;
+        std::string normalized = normalizeLine(rawLine);
+        if (normalized.empty()) continue;
+        if (!mentionsMacro(rawLine)) {
+            throw std::runtime_error("line " + std::to_string(inputLine) + ": only macro definitions are allowed");
+        }
+        storeMacro(fin, normalized);
+        if (!diagnostics.empty()) {
+            throw std::runtime_error("line " + std::to_string(diagnostics.front().line) + ": " +
+                                     diagnostics.front().message);
+        }
+    }
+}
+
+// Modo confinado: o caminho é relativo, não tem componente ".." e, seguindo
+// links simbólicos, o arquivo fica dentro de includeDir
+bool Preprocessor::isInsideIncludeDir(const std::string& path) const {
+    if (path.empty() || path[0] == '/') return false;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string::npos) end = path.size();
+        if (path.compare(start, end - start, "..") == 0) return false;
+        start = end + 1;
+    }
+
+    char rootPath[PATH_MAX];
+    char filePath[PATH_MAX];
+    if (!::realpath(includeDir.c_str(), rootPath)) return false;
+    // arquivo inexistente: a falha de abertura é relatada por includeLibrary
+    if (!::realpath((includeDir + "/" + path).c_str(), filePath)) return true;
+    std::string root = std::string(rootPath) + "/";
+    return std::string(filePath).compare(0, root.size(), root) == 0;
+}
+
+void Preprocessor::includeLibrary(const std::string& path, int line) {
+    if (includesConfined) {
+        if (includeDir.empty()) {
+            reportError(line, "INCLUDE is disabled (no include directory configured)");
+            return;
+        }
+        if (!isInsideIncludeDir(path)) {
+            reportError(line, "Include path outside the include directory: " + path);
+            return;
         }
-        
-        std::string norm = toUpper(trim(noComment)); // Usa 'noComment'
-        
-        if (norm.empty()) continue; // Pula linhas em branco
-
-        // Verifica o fim da macro
-        if (norm == "ENDMACRO") break;
-        
-        // Normaliza espaçamento e armazena a linha do corpo
-        norm = collapseSpaces(norm);
-        m.body.push_back(norm);
-    }
-    
-    // Armazena a macro finalizada no vetor
-    macros.push_back(std::move(m));
+    }
+
+    std::string resolved = path;
+    if (!includeDir.empty() && path[0] != '/') resolved = includeDir + "/" + path;
+
+    std::vector<Macro> library;
+    if (!MacroCache::load(resolved, *symbols, library)) {
+        std::ifstream fin(resolved);
+        if (!fin.is_open()) {
+            reportError(line, "Unable to open include file: " + path);
+            return;
+        }
+        Preprocessor parser;
+        parser.setSymbolPool(*symbols);
+        try {
+            parser.parseLibrary(fin);
+        } catch (const std::runtime_error& e) {
+            reportError(line, "Include file " + path + ", " + e.what());
+            return;
+        }
+        library = std::move(parser.macros);
+        MacroCache::store(resolved, *symbols, library);
+    }
+
+    // as macros passam a existir na linha do INCLUDE, como se definidas ali
+    for (auto& m : library) {
+        m.line = line;
+        m.bodyLines.assign(m.body.size(), line);
+        m.fromLibrary = true;
+        macros.push_back(std::move(m));
+    }
 }
 
-bool Preprocessor::isMacroCall(const std::string& line, const Macro*& outMacro, std::vector<std::string>& callArgs) const {
+bool Preprocessor::isMacroCall(const std::string& line, int callLine, const Macro*& outMacro,
+                               std::vector<std::string>& callArgs) const {
+    // a primeira palavra só pode ser uma macro se já estiver na tabela de símbolos
+    size_t end = line.find_first_of(" \t");
+    if (end == std::string::npos) end = line.size();
+    SymbolId word = symbols->find(std::string_view(line).substr(0, end));
+    if (word == SymbolPool::NONE) return false;
+
     for (const auto& m : macros) {
-        if (line.size() >= m.name.size() && line.compare(0, m.name.size(), m.name) == 0) {
-            if (line.size() == m.name.size()) {
-                outMacro = &m;
-                callArgs.clear();
-                return true;
-            }
-            char next = line[m.name.size()];
-            if (next == ' ' || next == '\t') {
-                std::string rest = trim(line.substr(m.name.size()));
-                
-                if (!rest.empty()) {
-                    auto parts = splitArgs(rest);
-                    callArgs.clear();
-                    for (auto& p : parts) callArgs.push_back(toUpper(p));
-                } else callArgs.clear();
-                outMacro = &m;
-                return true;
-            }
+        if (m.name != word || m.line >= callLine) continue;
+        callArgs.clear();
+        std::string rest = trim(line.substr(end));
+        if (!rest.empty()) {
+            auto parts = splitArgs(rest);
+            for (auto& p : parts) callArgs.push_back(toUpper(p));
         }
+        outMacro = &m;
+        return true;
     }
     return false;
 }
 
-std::string Preprocessor::substituteArgsInLine(const std::string& line, const std::vector<std::string>& formals, const std::vector<std::string>& actuals) {
+std::string Preprocessor::substituteArgsInLine(const std::string& line, const std::vector<SymbolId>& formals, const std::vector<std::string>& actuals) const {
     if (formals.empty()) return line;
     std::string out;
     out.reserve(line.size() + 16);
@@ -163,10 +316,11 @@ std::string Preprocessor::substituteArgsInLine(const std::string& line, const st
         if (isIdentChar(line[i])) {
             size_t j = i;
             while (j < line.size() && isIdentChar(line[j])) ++j;
-            std::string token = line.substr(i, j - i);
+            std::string_view token = std::string_view(line).substr(i, j - i);
+            SymbolId id = symbols->find(token);
             bool replaced = false;
-            for (size_t k = 0; k < formals.size() && k < actuals.size(); ++k) {
-                if (token == formals[k]) {
+            for (size_t k = 0; id != SymbolPool::NONE && k < formals.size() && k < actuals.size(); ++k) {
+                if (id == formals[k]) {
                     out += actuals[k];
                     replaced = true;
                     break;
@@ -182,11 +336,20 @@ std::string Preprocessor::substituteArgsInLine(const std::string& line, const st
     return out;
 }
 
-void Preprocessor::expandMacro(std::ofstream& fout, const Macro& macro, const std::vector<std::string>& args, int depth) {
-    if (depth > 20)
-        throw std::runtime_error("Macro expansion exceeded maximum depth (possible recursion)");
+void Preprocessor::emitLine(Sink& sink, const std::string& text, int asmLine, const std::string& origin) const {
+    sink.out << text << "\n";
+    if (trackLines) sink.origins.push_back({asmLine, origin.empty() ? "-" : origin});
+}
 
-    for (auto bline : macro.body) {
+bool Preprocessor::expandMacro(Sink& sink, const Macro& macro, const std::vector<std::string>& args, int callLine,
+                               int depth, const std::string& origin) const {
+    if (depth > 20) {
+        sink.diagnostics.push_back({callLine, "Macro", "Macro expansion exceeded maximum depth (possible recursion)"});
+        return false;
+    }
+
+    for (size_t b = 0; b < macro.body.size(); ++b) {
+        const std::string& bline = macro.body[b];
         // remove & do corpo da macro expandida
         std::string cleanLine;
         cleanLine.reserve(bline.size());
@@ -206,12 +369,15 @@ void Preprocessor::expandMacro(std::ofstream& fout, const Macro& macro, const st
         // Expansao recursiva de macros dentro de macros
         const Macro* inner = nullptr;
         std::vector<std::string> innerArgs;
-        if (isMacroCall(replaced, inner, innerArgs)) {
-            expandMacro(fout, *inner, innerArgs, depth + 1);
+        if (isMacroCall(replaced, callLine, inner, innerArgs)) {
+            std::string innerOrigin;
+            if (trackLines) innerOrigin = origin + ">" + symbols->str(inner->name) + "@" + std::to_string(macro.bodyLines[b]);
+            if (!expandMacro(sink, *inner, innerArgs, callLine, depth + 1, innerOrigin)) return false;
         } else {
-            fout << replaced << "\n";
+            emitLine(sink, replaced, macro.bodyLines[b], origin);
         }
     }
+    return true;
 }
 
 void Preprocessor::process(const std::string& inputFile) {
@@ -227,59 +393,217 @@ void Preprocessor::process(const std::string& inputFile) {
     std::ofstream fout(outFile);
     if (!fout.is_open()) throw std::runtime_error("Unable to create output file: " + outFile);
 
+    size_t slash = inputFile.find_last_of('/');
+    if (!includesConfined) includeDir = slash == std::string::npos ? "" : inputFile.substr(0, slash);
+
+    process(fin, fout);
+
+    // done
+    fout.close();
+    fin.close();
+    std::cerr << "Preprocessing finished. Output: " << outFile << "\n";
+
+    if (trackLines) writeLineOrigins(outFile);
+}
+
+void Preprocessor::reset() {
+    macros.clear();
+    ownSymbols.clear();
+    begin();
+}
+
+// Linha fora de definição de macro: reescreve ou expande a chamada
+bool Preprocessor::processLine(Sink& sink, const std::string& rawLine, int line) const {
+    std::string normalized = normalizeLine(rawLine);
+    if (normalized.empty()) return true; // skip blank lines
+
+    // trata linha com rótulo seguido de instrução na mesma linha
+    std::string label;
+    std::string lineToProcess = normalized;
+    size_t colonPos = lineToProcess.find(':');
+    if (colonPos != std::string::npos) {
+        // extrai o rótulo (incluindo ':') e o resto
+        label = lineToProcess.substr(0, colonPos + 1);
+        std::string after = trim(lineToProcess.substr(colonPos + 1));
+        if (after.empty()) {
+            // linha só com rótulo: escreve e segue
+            emitLine(sink, label, line, "");
+            return true;
+        }
+        lineToProcess = after;
+    }
+
+    // verifica se e chamada de macro sem rotulo
+    const Macro* called = nullptr;
+    std::vector<std::string> callArgs;
+    if (isMacroCall(lineToProcess, line, called, callArgs)) {
+        // se havia rótulo, escrevemos o rótulo em linha separada antes da expansão
+        if (!label.empty()) emitLine(sink, label, line, "");
+        std::string origin;
+        if (trackLines) origin = symbols->str(called->name) + "@" + std::to_string(line);
+        return expandMacro(sink, *called, callArgs, line, 0, origin);
+    }
+
+    // não é chamada de macro: reescreve mantendo o rótulo (se houver)
+    if (!label.empty()) {
+        emitLine(sink, label + " " + lineToProcess, line, "");
+    } else {
+        emitLine(sink, lineToProcess, line, "");
+    }
+    return true;
+}
+
+void Preprocessor::begin() {
+    inputLine = 0;
+    lineOrigins.clear();
+    diagnostics.clear();
+    inMacro = false;
+    pendingMacro = Macro();
+    pendingError.clear();
+}
+
+void Preprocessor::feedLine(const std::string& rawLine, std::ostream& fout) {
+    ++inputLine;
+
+    // dentro de uma definição: a linha vai para o corpo da macro
+    if (inMacro) {
+        addMacroLine(rawLine);
+        return;
+    }
+
+    std::string includePath;
+    if (isInclude(rawLine, includePath)) {
+        includeLibrary(includePath, inputLine);
+        if (!keepGoing && !diagnostics.empty()) throw std::runtime_error(diagnostics.front().message);
+        return;
+    }
+
+    // Se for definição de macro no cabeçalho (pode haver label: MACRO ...)
+    if (mentionsMacro(rawLine)) {
+        beginMacro(normalizeLine(rawLine));
+        if (!keepGoing && !diagnostics.empty()) throw std::runtime_error(diagnostics.front().message);
+        return;
+    }
+
+    Sink sink{fout, lineOrigins, diagnostics};
+    if (!processLine(sink, rawLine, inputLine) && !keepGoing)
+        throw std::runtime_error(diagnostics.front().message);
+}
+
+void Preprocessor::finish() {
+    if (inMacro) endMacro();
+}
+
+void Preprocessor::process(std::istream& fin, std::ostream& fout) {
+    begin();
+
+    if (threads > 1) {
+        processParallel(fin, fout);
+        return;
+    }
+
     std::string rawLine;
     while (std::getline(fin, rawLine)) {
-        // remove comentarios
-        std::string noComment;
-        size_t commentPos = rawLine.find(';');
-        if (commentPos != std::string::npos) noComment = rawLine.substr(0, commentPos);
-        else noComment = rawLine;
-
-        std::string normalized = toUpper(trim(noComment));
-        if (normalized.empty()) continue; // skip blank lines
-        normalized = collapseSpaces(normalized);
-
-        // Se for definição de macro no cabeçalho (pode haver label: MACRO ...)
-        if (normalized.find("MACRO") != std::string::npos) {
-            storeMacro(fin, normalized);
-            continue; 
-        }
+        feedLine(rawLine, fout);
+    }
+    finish();
+}
 
-        // trata linha com rótulo seguido de instrução na mesma linha
-        std::string label;
-        std::string lineToProcess = normalized;
-        size_t colonPos = lineToProcess.find(':');
-        if (colonPos != std::string::npos) {
-            // extrai o rótulo (incluindo ':') e o resto
-            label = lineToProcess.substr(0, colonPos + 1);
-            std::string after = trim(lineToProcess.substr(colonPos + 1));
-            if (after.empty()) {
-                // linha só com rótulo: escreve e segue
-                fout << label << "\n";
-                continue;
-            }
-            lineToProcess = after;
+// Fase 1 (sequencial): lê o arquivo e registra as definições de macro e os
+// INCLUDEs; as demais linhas são guardadas cruas. Fase 2: as linhas são
+// divididas em blocos normalizados e expandidos em paralelo, cada um com sua
+// saída, e os blocos são concatenados em ordem. Uma chamada só enxerga as macros
+// definidas antes da sua linha, como no modo sequencial.
+void Preprocessor::processParallel(std::istream& fin, std::ostream& fout) {
+    struct SourceLine {
+        int line;
+        std::string text;
+    };
+    std::vector<SourceLine> lines;
+
+    std::string rawLine;
+    std::string includePath;
+    while (std::getline(fin, rawLine)) {
+        ++inputLine;
+        if (isInclude(rawLine, includePath)) {
+            includeLibrary(includePath, inputLine);
+            if (!keepGoing && !diagnostics.empty()) break;
+            continue;
+        }
+        if (mentionsMacro(rawLine)) {
+            storeMacro(fin, normalizeLine(rawLine));
+            // sem -k o processamento para aqui; as linhas anteriores ainda são
+            // expandidas para que o primeiro erro do arquivo seja o reportado
+            if (!keepGoing && !diagnostics.empty()) break;
+            continue;
         }
+        lines.push_back({inputLine, std::move(rawLine)});
+    }
 
-        // verifica se e chamada de macro sem rotulo
-        const Macro* called = nullptr;
-        std::vector<std::string> callArgs;
-        if (isMacroCall(lineToProcess, called, callArgs)) {
-            // se havia rótulo, escrevemos o rótulo em linha separada antes da expansão
-            if (!label.empty()) fout << label << "\n";
-            expandMacro(fout, *called, callArgs, 0);
-        } else {
-            // não é chamada de macro: reescreve mantendo o rótulo (se houver)
-            if (!label.empty()) {
-                fout << label << " " << lineToProcess << "\n";
-            } else {
-                fout << lineToProcess << "\n";
+    struct Chunk {
+        size_t begin;
+        size_t end;
+        std::ostringstream out;
+        std::vector<LineOrigin> origins;
+        std::vector<Diagnostic> diagnostics;
+    };
+    const size_t minChunkLines = 256;
+    size_t chunkLines = std::max(minChunkLines, lines.size() / (threads * 4) + 1);
+    std::vector<Chunk> chunks((lines.size() + chunkLines - 1) / chunkLines);
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        chunks[c].begin = c * chunkLines;
+        chunks[c].end = std::min(lines.size(), (c + 1) * chunkLines);
+    }
+
+    std::atomic<size_t> next(0);
+    std::vector<std::exception_ptr> errors(chunks.size());
+    auto work = [&]() {
+        size_t c;
+        while ((c = next++) < chunks.size()) {
+            Chunk& chunk = chunks[c];
+            Sink sink{chunk.out, chunk.origins, chunk.diagnostics};
+            try {
+                for (size_t i = chunk.begin; i < chunk.end; ++i) {
+                    if (!processLine(sink, lines[i].text, lines[i].line) && !keepGoing) break;
+                }
+            } catch (...) {
+                errors[c] = std::current_exception();
             }
         }
+    };
+    std::vector<std::thread> workers;
+    size_t workerCount = std::min<size_t>(threads, chunks.size());
+    for (size_t w = 1; w < workerCount; ++w) workers.emplace_back(work);
+    work();
+    for (auto& t : workers) t.join();
+    for (auto& e : errors) {
+        if (e) std::rethrow_exception(e);
     }
 
-    // done
-    fout.close();
-    fin.close();
-    std::cerr << "Preprocessing finished. Output: " << outFile << "\n";
+    // concatena em ordem; sem -k a saída termina no bloco do primeiro erro
+    std::vector<Diagnostic> macroErrors;
+    macroErrors.swap(diagnostics);
+    for (auto& chunk : chunks) {
+        fout << chunk.out.str();
+        lineOrigins.insert(lineOrigins.end(), chunk.origins.begin(), chunk.origins.end());
+        diagnostics.insert(diagnostics.end(), chunk.diagnostics.begin(), chunk.diagnostics.end());
+        if (!keepGoing && !chunk.diagnostics.empty()) break;
+    }
+    diagnostics.insert(diagnostics.end(), macroErrors.begin(), macroErrors.end());
+    std::stable_sort(diagnostics.begin(), diagnostics.end(),
+                     [](const Diagnostic& a, const Diagnostic& b) { return a.line < b.line; });
+
+    if (!keepGoing && !diagnostics.empty()) throw std::runtime_error(diagnostics.front().message);
+}
+
+// Formato do .pmap: uma linha por linha do .pre, "<linha .asm> <pilha de macros>"
+void Preprocessor::writeLineOrigins(const std::string& outFile) const {
+    std::string mapFile = outFile.substr(0, outFile.find_last_of('.')) + ".pmap";
+    std::ofstream fmap(mapFile);
+    if (!fmap.is_open()) throw std::runtime_error("Unable to create output file: " + mapFile);
+
+    for (const auto& o : lineOrigins) {
+        fmap << o.asmLine << " " << o.macroStack << "\n";
+    }
+    std::cerr << "Line map written: " << mapFile << "\n";
 }
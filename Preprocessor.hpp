@@ -2,27 +2,111 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
+#include <iostream>
 #include "Macro.hpp"
+#include "Diagnostic.hpp"
+#include "SymbolPool.hpp"
+
+// origem de uma linha do .pre: linha do .asm e pilha de chamadas de macro
+struct LineOrigin {
+    int asmLine;
+    std::string macroStack; // "-" fora de macro, ou "SQR@28>DUP@7"
+};
 
 class Preprocessor {
 private:
     std::vector<Macro> macros; // supports more but will warn if >2
 
+    SymbolPool ownSymbols;
+    SymbolPool* symbols = &ownSymbols; // nomes de macro e argumentos; pode ser compartilhada com o Assembler
+
+    int inputLine = 0; // linha atual do .asm
+    bool trackLines = false;
+    std::vector<LineOrigin> lineOrigins; // uma entrada por linha emitida no .pre
+
+    bool keepGoing = false; // modo de diagnóstico: acumula os erros e continua
+    std::vector<Diagnostic> diagnostics;
+
+    std::string includeDir;       // diretório do .asm, base dos caminhos de INCLUDE
+    bool includesConfined = false; // INCLUDE só dentro de includeDir (vazio: desativado)
+    bool parsingLibrary = false;  // lendo uma biblioteca: sem limite de macros
+
+    // definição de macro em andamento (entre o cabeçalho e o ENDMACRO)
+    bool inMacro = false;
+    Macro pendingMacro;
+    std::string pendingError;     // erro do cabeçalho: a macro não é armazenada
+
+    unsigned threads = 1; // > 1: expansão em duas fases (macros primeiro, linhas em paralelo)
+
+    // destino da expansão de um trecho do arquivo; no modo paralelo cada
+    // bloco de linhas tem o seu, concatenado em ordem no final
+    struct Sink {
+        std::ostream& out;
+        std::vector<LineOrigin>& origins;
+        std::vector<Diagnostic>& diagnostics;
+    };
+
     static std::string toUpper(const std::string& s);
     static std::string trim(const std::string& s);
     static std::string collapseSpaces(const std::string& s);
     static std::vector<std::string> splitArgs(const std::string& s);
+    static std::string normalizeLine(const std::string& rawLine);
+    static bool mentionsMacro(const std::string& rawLine);
+    static bool isInclude(const std::string& rawLine, std::string& path);
 
-    void storeMacro(std::ifstream& fin, const std::string& firstLine);
-    bool isMacroCall(const std::string& line, const Macro*& outMacro, std::vector<std::string>& callArgs) const;
-    void expandMacro(std::ofstream& fout, const Macro& macro, const std::vector<std::string>& args, int depth = 0);
+    // false se o cabeçalho tem erro fora do modo -k (o corpo não é lido)
+    bool beginMacro(const std::string& firstLine);
+    void addMacroLine(const std::string& rawLine);
+    void endMacro();
+    void storeMacro(std::istream& fin, const std::string& firstLine);
+    // INCLUDE <arquivo>: carrega as macros da biblioteca (do .mcache, se válido)
+    void includeLibrary(const std::string& path, int line);
+    bool isInsideIncludeDir(const std::string& path) const;
+    void parseLibrary(std::istream& fin);
+    // só considera macros definidas antes de callLine
+    bool isMacroCall(const std::string& line, int callLine, const Macro*& outMacro,
+                     std::vector<std::string>& callArgs) const;
+    void reportError(int line, const std::string& message);
+    // processLine e expandMacro não alteram o estado da instância (só leem as
+    // macros e a tabela de símbolos), então podem rodar em paralelo.
+    // Retornam false se a expansão falhou (erro já registrado em sink)
+    bool processLine(Sink& sink, const std::string& rawLine, int line) const;
+    bool expandMacro(Sink& sink, const Macro& macro, const std::vector<std::string>& args, int callLine,
+                     int depth = 0, const std::string& origin = "") const;
+    void emitLine(Sink& sink, const std::string& text, int asmLine, const std::string& origin) const;
+    void processParallel(std::istream& fin, std::ostream& fout);
+    void writeLineOrigins(const std::string& outFile) const;
 
 
     // replace formal args by actuals, but replace only whole tokens (alnum or '_')
-    static std::string substituteArgsInLine(const std::string& line, const std::vector<std::string>& formals, const std::vector<std::string>& actuals);
+    std::string substituteArgsInLine(const std::string& line, const std::vector<SymbolId>& formals, const std::vector<std::string>& actuals) const;
 
 public:
     Preprocessor() = default;
+    Preprocessor(const Preprocessor&) = delete;
+    Preprocessor& operator=(const Preprocessor&) = delete;
+    // usa uma tabela de símbolos externa (ex.: a mesma do Assembler); reset() não a limpa
+    void setSymbolPool(SymbolPool& pool) { symbols = &pool; }
+    // grava <arquivo>.pmap com a origem (.asm/macro) de cada linha do .pre
+    void setLineTracking(bool enabled) { trackLines = enabled; }
+    void setDiagnosticsMode(bool enabled) { keepGoing = enabled; }
+    // número de threads da expansão; o .pre é idêntico ao do modo sequencial (1)
+    void setThreads(unsigned count) { threads = count == 0 ? 1 : count; }
+    // base dos caminhos de INCLUDE quando o .asm não é lido por process(arquivo)
+    void setIncludeDir(const std::string& dir) { includeDir = dir; }
+    // código de terceiros (servidor): INCLUDE aceita só caminhos relativos,
+    // sem "..", de arquivos dentro de dir; com dir vazio, INCLUDE é recusado
+    void confineIncludes(const std::string& dir) { includeDir = dir; includesConfined = true; }
+    const std::vector<Diagnostic>& getDiagnostics() const { return diagnostics; }
     void process(const std::string& inputFile);
-};
\ No newline at end of file
+    // versão em memória: lê o .asm de in e escreve o .pre em out
+    void process(std::istream& fin, std::ostream& fout);
+    // Interface incremental, para quem já tem as linhas do .asm (ex.: o
+    // pipeline): begin(), feedLine() para cada linha em ordem e finish()
+    void begin();
+    void feedLine(const std::string& rawLine, std::ostream& fout);
+    void finish();
+    // descarta as macros, o mapa de linhas e os símbolos próprios, para reutilizar a instância
+    void reset();
+    const std::vector<LineOrigin>& getLineOrigins() const { return lineOrigins; }
+};
@@ -0,0 +1,310 @@
+#include "Server.hpp"
+#include "Assembler.hpp"
+#include "Preprocessor.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// leitura bufferizada de um descritor: linhas de cabeçalho e blocos de bytes
+class FdReader {
+private:
+    int fd;
+    std::vector<char> buffer;
+    size_t pos = 0;
+    size_t len = 0;
+
+    bool fill() {
+        if (pos == len) pos = len = 0;
+        while (true) {
+            ssize_t n = ::read(fd, buffer.data() + len, buffer.size() - len);
+            if (n > 0) { len += static_cast<size_t>(n); return true; }
+            if (n < 0 && errno == EINTR) continue;
+            return false;
+        }
+    }
+
+public:
+    explicit FdReader(int fd) : fd(fd), buffer(1 << 16) {}
+
+    bool readLine(std::string& line) {
+        line.clear();
+        while (true) {
+            for (size_t i = pos; i < len; ++i) {
+                if (buffer[i] == '\n') {
+                    line.append(buffer.data() + pos, i - pos);
+                    pos = i + 1;
+                    return true;
+                }
+            }
+            line.append(buffer.data() + pos, len - pos);
+            pos = len;
+            if (!fill()) return !line.empty();
+        }
+    }
+
+    // count já foi limitado pelo chamador; a string cresce com os dados recebidos
+    bool readBytes(size_t count, std::string& out) {
+        out.clear();
+        while (out.size() < count) {
+            if (pos == len && !fill()) return false;
+            size_t take = std::min(count - out.size(), len - pos);
+            out.append(buffer.data() + pos, take);
+            pos += take;
+        }
+        return true;
+    }
+};
+
+bool writeAll(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+Server::Channel::~Channel() {
+    if (ownsFds) {
+        ::close(inFd);
+        if (outFd != inFd) ::close(outFd);
+    }
+}
+
+Server::Server(unsigned workerCount, const std::string& includeDir) : includeDir(includeDir) {
+    if (workerCount == 0) workerCount = 1;
+    for (unsigned i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&Server::workerLoop, this);
+    }
+}
+
+Server::~Server() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+void Server::enqueue(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back(std::move(job));
+    }
+    queueReady.notify_one();
+}
+
+// Um cliente com erro (cabeçalho inválido, tamanho acima do limite, falta de
+// memória) perde só a própria conexão, nunca o processo
+void Server::readJobs(const std::shared_ptr<Channel>& channel) {
+    try {
+        FdReader reader(channel->inFd);
+        std::string header;
+        while (reader.readLine(header)) {
+            if (header.empty()) continue;
+            if (header == "QUIT") break;
+
+            std::istringstream ss(header);
+            std::string tag;
+            size_t bytes = 0;
+            Job job;
+            job.channel = channel;
+            if (!(ss >> tag >> job.id >> job.kind >> bytes) || tag != "JOB") {
+                std::string message = "Invalid request header: " + header;
+                sendReply(*channel, "ERROR - " + std::to_string(message.size()) + "\n" + message);
+                break; // sem o tamanho não há como ressincronizar
+            }
+            if (bytes > MAX_PAYLOAD) {
+                std::string message = "Payload too large: " + std::to_string(bytes) +
+                                      " bytes (limit " + std::to_string(MAX_PAYLOAD) + ")";
+                sendReply(*channel, "ERROR " + job.id + " " + std::to_string(message.size()) + "\n" + message);
+                break; // o código não é lido, então a conexão é encerrada
+            }
+            std::string option;
+            while (ss >> option) job.options.push_back(option);
+
+            if (!reader.readBytes(bytes, job.payload)) break;
+            enqueue(std::move(job));
+        }
+    } catch (const std::exception& ex) {
+        std::string message = ex.what();
+        sendReply(*channel, "ERROR - " + std::to_string(message.size()) + "\n" + message);
+    }
+}
+
+void Server::workerLoop() {
+    // instâncias quentes desta thread, reutilizadas entre jobs; as duas
+    // etapas compartilham a mesma tabela de símbolos
+    SymbolPool symbols;
+    Preprocessor pre;
+    Assembler assembler;
+    pre.setSymbolPool(symbols);
+    assembler.setSymbolPool(symbols);
+    // o código vem do cliente: INCLUDE não pode ler (nem gravar .mcache) fora do diretório configurado
+    pre.confineIncludes(includeDir);
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        Sections sections;
+        std::string reply;
+        auto start = std::chrono::steady_clock::now();
+        try {
+            symbols.clear();
+            runJob(pre, assembler, job, sections);
+            auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            reply = "DONE " + job.id + " " + std::to_string(sections.size()) + " " + std::to_string(micros) + "\n";
+            for (const auto& section : sections) {
+                reply += section.first + " " + std::to_string(section.second.size()) + "\n" + section.second;
+            }
+        } catch (const std::exception& ex) {
+            std::string message = ex.what();
+            reply = "ERROR " + job.id + " " + std::to_string(message.size()) + "\n" + message;
+        }
+        sendReply(*job.channel, reply);
+    }
+}
+
+namespace {
+
+std::string formatDiagnostics(const std::vector<Diagnostic>& diagnostics) {
+    std::string text;
+    for (const auto& d : diagnostics) text += std::to_string(d.line) + ": " + d.message + "\n";
+    return text;
+}
+
+} // namespace
+
+void Server::runJob(Preprocessor& pre, Assembler& assembler, const Job& job, Sections& sections) {
+    bool object = false;
+    bool keepGoing = false;
+    bool flow = false;
+    assembler.setOptimization(false);
+    assembler.setDataOptimization(false);
+    for (const auto& option : job.options) {
+        if (option == "-O") assembler.setOptimization(true);
+        else if (option == "-Od") assembler.setDataOptimization(true);
+        else if (option == "obj") object = true;
+        else if (option == "-k") keepGoing = true;
+        else if (option == "-a") flow = true;
+        else throw std::runtime_error("Unknown option: " + option);
+    }
+
+    std::string source = job.payload;
+    if (job.kind == "pre" || job.kind == "build") {
+        pre.reset();
+        pre.setDiagnosticsMode(keepGoing);
+        std::istringstream in(job.payload);
+        std::ostringstream out;
+        pre.process(in, out);
+        if (!pre.getDiagnostics().empty()) {
+            sections.push_back({"diag", formatDiagnostics(pre.getDiagnostics())});
+            return;
+        }
+        source = out.str();
+        sections.push_back({"pre", source});
+        if (job.kind == "pre") return;
+    } else if (job.kind != "asm") {
+        throw std::runtime_error("Unknown job type: " + job.kind);
+    }
+
+    std::ostringstream log;
+    assembler.reset();
+    assembler.setLog(log);
+    assembler.setDiagnosticsMode(keepGoing);
+    std::istringstream in(source);
+    assembler.compile(in);
+    if (!assembler.getDiagnostics().empty()) {
+        sections.push_back({"diag", formatDiagnostics(assembler.getDiagnostics())});
+        return;
+    }
+    if (object) {
+        sections.push_back({"obj", assembler.formatObjectOutput(job.id)});
+    } else {
+        sections.push_back({"o1", assembler.formatRawOutput()});
+        sections.push_back({"o2", assembler.formatFinalOutput()});
+    }
+    if (flow) {
+        auto analysis = assembler.formatFlowAnalysis(job.id);
+        sections.push_back({"cfg", analysis.first});
+        sections.push_back({"dot", analysis.second});
+    }
+    if (!log.str().empty()) sections.push_back({"log", log.str()});
+}
+
+void Server::sendReply(Channel& channel, const std::string& reply) {
+    std::lock_guard<std::mutex> lock(channel.writeMutex);
+    writeAll(channel.outFd, reply);
+}
+
+void Server::serveStdio() {
+    auto channel = std::make_shared<Channel>(STDIN_FILENO, STDOUT_FILENO, false);
+    readJobs(channel);
+    // o destrutor espera a fila esvaziar antes de encerrar as threads
+}
+
+void Server::serveSocket(const std::string& path) {
+    int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("Socket path too long: " + path);
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    ::unlink(path.c_str());
+
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(listenFd, 64) < 0) {
+        std::string error = std::strerror(errno);
+        ::close(listenFd);
+        throw std::runtime_error("Unable to listen on " + path + ": " + error);
+    }
+    std::cerr << "Listening on " << path << "\n";
+
+    while (true) {
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            std::string error = std::strerror(errno);
+            ::close(listenFd);
+            throw std::runtime_error("accept: " + error);
+        }
+        auto channel = std::make_shared<Channel>(fd, fd, true);
+
+        // no máximo MAX_CONNECTIONS threads de leitura: as demais conexões
+        // esperam na fila do listen até uma terminar
+        {
+            std::unique_lock<std::mutex> lock(connectionMutex);
+            connectionSlot.wait(lock, [this] { return activeConnections < MAX_CONNECTIONS; });
+            ++activeConnections;
+        }
+        std::thread([this, channel] {
+            readJobs(channel);
+            {
+                std::lock_guard<std::mutex> lock(connectionMutex);
+                --activeConnections;
+            }
+            connectionSlot.notify_one();
+        }).detach();
+    }
+}
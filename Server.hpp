@@ -0,0 +1,81 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class Preprocessor;
+class Assembler;
+
+// Servidor residente de montagem. Cada thread de trabalho mantém um
+// Preprocessor e um Assembler "quentes", reiniciados com reset() a cada job,
+// que compartilham uma SymbolPool (nomes de macro e rótulos internados uma vez).
+//
+// Protocolo (stdin/stdout ou socket Unix, mesmo enquadramento):
+//   requisição: JOB <id> <tipo> <bytes> [opcoes...]\n seguido de <bytes> de código
+//     tipo:   pre   (.asm -> .pre)
+//             asm   (.pre -> .o1 e .o2, ou .obj com a opção obj)
+//             build (.asm -> .pre -> .o1 e .o2)
+//     opções: -O, -Od, obj, -a (seções cfg e dot),
+//             -k (todos os erros na seção diag, sem as demais)
+//   QUIT\n encerra a conexão. <bytes> acima de MAX_PAYLOAD recebe ERROR e a
+//   conexão é encerrada; no socket há no máximo MAX_CONNECTIONS conexões ativas.
+//   INCLUDE só lê bibliotecas dentro do diretório dado ao servidor (-I), com
+//   caminho relativo e sem ".."; sem -I os jobs não podem usar INCLUDE.
+//   resposta:   DONE <id> <secoes> <microssegundos>\n e, para cada seção,
+//               <nome> <bytes>\n<conteúdo>   (nomes: pre, o1, o2, obj, cfg, dot, log, diag)
+//               ERROR <id> <bytes>\n<mensagem>
+// As respostas podem sair fora de ordem; o id identifica o job.
+class Server {
+private:
+    struct Channel {
+        int inFd;
+        int outFd;
+        bool ownsFds;
+        std::mutex writeMutex;
+        Channel(int in, int out, bool owns) : inFd(in), outFd(out), ownsFds(owns) {}
+        ~Channel();
+    };
+
+    struct Job {
+        std::shared_ptr<Channel> channel;
+        std::string id;
+        std::string kind;
+        std::vector<std::string> options;
+        std::string payload;
+    };
+
+    using Sections = std::vector<std::pair<std::string, std::string>>;
+
+    std::deque<Job> queue;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    bool stopping = false;
+    std::string includeDir;
+    std::vector<std::thread> workers;
+
+    static const size_t MAX_PAYLOAD = 4 * 1024 * 1024;  // programas de 216 palavras têm poucos KB
+    static const unsigned MAX_CONNECTIONS = 64;
+    std::mutex connectionMutex;
+    std::condition_variable connectionSlot;
+    unsigned activeConnections = 0;
+
+    void workerLoop();
+    void readJobs(const std::shared_ptr<Channel>& channel);
+    void enqueue(Job job);
+    static void runJob(Preprocessor& pre, Assembler& assembler, const Job& job, Sections& sections);
+    static void sendReply(Channel& channel, const std::string& reply);
+
+public:
+    // includeDir: raiz dos INCLUDEs dos jobs (vazio: INCLUDE recusado)
+    explicit Server(unsigned workerCount, const std::string& includeDir = "");
+    ~Server();
+
+    void serveStdio();
+    void serveSocket(const std::string& path);
+};
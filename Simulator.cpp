@@ -0,0 +1,298 @@
+#include "Simulator.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+Simulator::Simulator(bool profiling) : memory(MEMORY_SIZE, 0), profiling(profiling) {
+    if (profiling) {
+        execCount.assign(MEMORY_SIZE, 0);
+        takenCount.assign(MEMORY_SIZE, 0);
+        notTakenCount.assign(MEMORY_SIZE, 0);
+        readCount.assign(MEMORY_SIZE, 0);
+        writeCount.assign(MEMORY_SIZE, 0);
+    }
+}
+
+int Simulator::instructionSize(int opcode) {
+    if (opcode == COPY) return 3;
+    if (opcode == STOP) return 1;
+    return 2;
+}
+
+void Simulator::load(const std::string& objectFile) {
+    std::ifstream fin(objectFile);
+    if (!fin.is_open()) throw std::runtime_error("Unable to open object file: " + objectFile);
+
+    size_t dot = objectFile.find_last_of('.');
+    size_t slash = objectFile.find_last_of("/\\");
+    bool hasExtension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+    baseName = hasExtension ? objectFile.substr(0, dot) : objectFile;
+    hasDebugInfo = debugInfo.read(baseName + ".dbg");
+
+    int word;
+    imageSize = 0;
+    while (fin >> word) {
+        if (imageSize >= MEMORY_SIZE)
+            throw std::runtime_error("Object file does not fit in memory (" + std::to_string(MEMORY_SIZE) + " words)");
+        memory[imageSize++] = word;
+    }
+    if (!fin.eof()) throw std::runtime_error("Invalid word in object file: " + objectFile);
+}
+
+int Simulator::readWord(int address) {
+    if (address < 0 || address >= MEMORY_SIZE)
+        throw std::runtime_error("Invalid memory read at address " + std::to_string(address) + describe(pc));
+    if (profiling) ++readCount[address];
+    return memory[address];
+}
+
+void Simulator::writeWord(int address, int value) {
+    if (address < 0 || address >= MEMORY_SIZE)
+        throw std::runtime_error("Invalid memory write at address " + std::to_string(address) + describe(pc));
+    if (profiling) ++writeCount[address];
+    memory[address] = value;
+}
+
+// operandos são lidos sem contar como acesso a dados
+int Simulator::operand(int offset) const {
+    int address = pc + offset;
+    if (address >= MEMORY_SIZE)
+        throw std::runtime_error("Instruction at " + std::to_string(pc) + describe(pc) + " runs past the end of memory");
+    return memory[address];
+}
+
+// posição no código-fonte para mensagens de erro
+std::string Simulator::describe(int address) const {
+    std::string where = " (pc=" + std::to_string(pc);
+    if (hasDebugInfo) {
+        int preLine = debugInfo.preLineForAddress(address);
+        int asmLine = debugInfo.asmLineForPreLine(preLine);
+        if (preLine > 0) where += ", .pre line " + std::to_string(preLine);
+        if (asmLine > 0) where += ", .asm line " + std::to_string(asmLine);
+        if (debugInfo.originForPreLine(preLine) != "-") where += ", macro " + debugInfo.originForPreLine(preLine);
+    }
+    return where + ")";
+}
+
+void Simulator::branch(bool taken, int target) {
+    if (profiling) {
+        if (taken) ++takenCount[pc];
+        else ++notTakenCount[pc];
+    }
+    pc = taken ? target : pc + 2;
+}
+
+void Simulator::setInput(std::vector<int> values) {
+    input.setValues(std::move(values));
+    inputPreset = true;
+}
+
+void Simulator::run(std::istream& in, std::ostream& out) {
+    if (interactive) input.setInteractive(in);
+    else if (!inputPreset) input.load(in);
+    inputPreset = false;
+    output.open(out, interactive);
+
+    try {
+        execute();
+    } catch (...) {
+        output.flush(); // o que foi escrito antes do erro continua visível
+        throw;
+    }
+}
+
+void Simulator::execute() {
+    acc = 0;
+    pc = 0;
+    executed = 0;
+
+    while (true) {
+        if (pc < 0 || pc >= MEMORY_SIZE)
+            throw std::runtime_error("Program counter out of memory: " + std::to_string(pc));
+
+        int opcode = memory[pc];
+        if (profiling) ++execCount[pc];
+        ++executed;
+
+        switch (opcode) {
+            case ADD:  acc += readWord(operand(1)); pc += 2; break;
+            case SUB:  acc -= readWord(operand(1)); pc += 2; break;
+            case MULT: acc *= readWord(operand(1)); pc += 2; break;
+            case DIV: {
+                int divisor = readWord(operand(1));
+                if (divisor == 0) throw std::runtime_error("Division by zero at address " + std::to_string(pc) + describe(pc));
+                acc /= divisor;
+                pc += 2;
+                break;
+            }
+            case JMP:  branch(true, operand(1)); break;
+            case JMPN: branch(acc < 0, operand(1)); break;
+            case JMPP: branch(acc > 0, operand(1)); break;
+            case JMPZ: branch(acc == 0, operand(1)); break;
+            case COPY: writeWord(operand(2), readWord(operand(1))); pc += 3; break;
+            case LOAD: acc = readWord(operand(1)); pc += 2; break;
+            case STORE: writeWord(operand(1), acc); pc += 2; break;
+            case INPUT: {
+                int value;
+                if (!input.read(value)) throw std::runtime_error("Unable to read INPUT value" + describe(pc));
+                writeWord(operand(1), value);
+                pc += 2;
+                break;
+            }
+            case OUTPUT: output.write(readWord(operand(1))); pc += 2; break;
+            case STOP: output.flush(); return;
+            default:
+                throw std::runtime_error("Invalid opcode " + std::to_string(opcode) + " at address " + std::to_string(pc) + describe(pc));
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Relatório de perfil
+// ----------------------------------------------------------------------------
+
+namespace {
+
+struct SourceInfo {
+    int preLine = 0;       // 0 quando não há .dbg
+    int asmLine = 0;       // 0 quando o .dbg não tem a origem das linhas
+    std::string stack = "-";
+    std::string text;
+};
+
+std::vector<std::string> readLines(const std::string& file) {
+    std::vector<std::string> lines;
+    std::ifstream fin(file);
+    std::string line;
+    while (std::getline(fin, line)) lines.push_back(line);
+    return lines;
+}
+
+// mapeia cada endereço para a linha do .pre e do .asm que o gerou
+std::vector<SourceInfo> loadSourceInfo(const DebugInfo& debugInfo, const std::string& baseName, int size) {
+    std::vector<SourceInfo> info(size);
+    std::vector<std::string> preText = readLines(baseName + ".pre");
+
+    for (int a = 0; a < size; ++a) {
+        SourceInfo& si = info[a];
+        si.preLine = debugInfo.preLineForAddress(a);
+        si.asmLine = debugInfo.asmLineForPreLine(si.preLine);
+        si.stack = debugInfo.originForPreLine(si.preLine);
+        if (si.preLine >= 1 && si.preLine <= static_cast<int>(preText.size())) {
+            si.text = preText[si.preLine - 1];
+        }
+    }
+    return info;
+}
+
+std::string lineOrDash(int line) {
+    return line > 0 ? std::to_string(line) : "-";
+}
+
+std::string percent(unsigned long long part, unsigned long long total) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(2) << (total ? 100.0 * part / total : 0.0);
+    return ss.str();
+}
+
+} // namespace
+
+void Simulator::writeProfile() const {
+    if (!profiling) throw std::runtime_error("Profiling was not enabled");
+
+    std::vector<SourceInfo> info = loadSourceInfo(debugInfo, baseName, MEMORY_SIZE);
+
+    std::vector<int> hot;
+    for (int a = 0; a < MEMORY_SIZE; ++a)
+        if (execCount[a] > 0) hot.push_back(a);
+    std::stable_sort(hot.begin(), hot.end(), [&](int x, int y) { return execCount[x] > execCount[y]; });
+
+    std::string profFile = baseName + ".prof";
+    std::ofstream fprof(profFile);
+    if (!fprof.is_open()) throw std::runtime_error("Unable to create output file: " + profFile);
+
+    fprof << "Instrucoes executadas: " << executed << "\n\n";
+
+    fprof << "=== Hot spots por instrucao ===\n";
+    fprof << std::setw(12) << "execucoes" << std::setw(8) << "%" << std::setw(6) << "end"
+          << std::setw(6) << ".pre" << std::setw(6) << ".asm" << "  " << std::left << std::setw(20) << "macro"
+          << "instrucao\n" << std::right;
+    for (int a : hot) {
+        const SourceInfo& si = info[a];
+        fprof << std::setw(12) << execCount[a] << std::setw(8) << percent(execCount[a], executed)
+              << std::setw(6) << a << std::setw(6) << lineOrDash(si.preLine) << std::setw(6) << lineOrDash(si.asmLine)
+              << "  " << std::left << std::setw(20) << si.stack << si.text << "\n" << std::right;
+    }
+
+    // agrega por linha do .asm: corpos de macro somam todas as expansões
+    std::map<std::pair<int, std::string>, unsigned long long> byAsmLine;
+    for (int a : hot) {
+        std::string macro = info[a].stack;
+        size_t last = macro.find_last_of('>');
+        if (last != std::string::npos) macro = macro.substr(last + 1);
+        macro = macro.substr(0, macro.find('@'));
+        byAsmLine[{info[a].asmLine, macro}] += execCount[a];
+    }
+    std::vector<std::pair<std::pair<int, std::string>, unsigned long long>> asmHot(byAsmLine.begin(), byAsmLine.end());
+    std::stable_sort(asmHot.begin(), asmHot.end(), [](const auto& x, const auto& y) { return x.second > y.second; });
+
+    fprof << "\n=== Hot spots por linha do .asm ===\n";
+    fprof << std::setw(12) << "execucoes" << std::setw(8) << "%" << std::setw(6) << ".asm" << "  macro\n";
+    for (const auto& entry : asmHot) {
+        fprof << std::setw(12) << entry.second << std::setw(8) << percent(entry.second, executed)
+              << std::setw(6) << lineOrDash(entry.first.first) << "  " << entry.first.second << "\n";
+    }
+
+    fprof << "\n=== Desvios ===\n";
+    fprof << std::setw(6) << "end" << std::setw(12) << "tomados" << std::setw(12) << "nao tomados" << std::setw(6) << ".asm" << "\n";
+    for (int a = 0; a < MEMORY_SIZE; ++a) {
+        if (takenCount[a] == 0 && notTakenCount[a] == 0) continue;
+        fprof << std::setw(6) << a << std::setw(12) << takenCount[a] << std::setw(12) << notTakenCount[a]
+              << std::setw(6) << lineOrDash(info[a].asmLine) << "\n";
+    }
+
+    fprof << "\n=== Acessos a memoria ===\n";
+    fprof << std::setw(6) << "end" << std::setw(12) << "leituras" << std::setw(12) << "escritas" << std::setw(6) << ".asm"
+          << "  simbolo\n";
+    for (int a = 0; a < MEMORY_SIZE; ++a) {
+        if (readCount[a] == 0 && writeCount[a] == 0) continue;
+        fprof << std::setw(6) << a << std::setw(12) << readCount[a] << std::setw(12) << writeCount[a]
+              << std::setw(6) << lineOrDash(info[a].asmLine) << "  ";
+        const DebugInfo::Symbol* sym = debugInfo.symbolForAddress(a);
+        if (sym) {
+            fprof << sym->label;
+            if (sym->address != a) fprof << " + " << a - sym->address;
+        }
+        fprof << "\n";
+    }
+    fprof.close();
+    std::cerr << "Profile written: " << profFile << "\n";
+
+    // formato "folded stacks" (flamegraph.pl): frame;frame;frame contagem
+    std::string program = baseName.substr(baseName.find_last_of("/\\") + 1);
+    std::map<std::string, unsigned long long> folded;
+    for (int a : hot) {
+        const SourceInfo& si = info[a];
+        std::string stack = program;
+        if (si.stack != "-") {
+            std::stringstream frames(si.stack);
+            std::string frame;
+            while (std::getline(frames, frame, '>')) {
+                size_t at = frame.find('@');
+                stack += ";" + frame.substr(0, at) + "@L" + frame.substr(at + 1);
+            }
+        }
+        stack += ";" + (si.asmLine > 0 ? "L" + std::to_string(si.asmLine) : "end " + std::to_string(a));
+        if (!si.text.empty()) stack += " " + si.text;
+        folded[stack] += execCount[a];
+    }
+
+    std::string foldedFile = baseName + ".folded";
+    std::ofstream ffold(foldedFile);
+    if (!ffold.is_open()) throw std::runtime_error("Unable to create output file: " + foldedFile);
+    for (const auto& entry : folded) ffold << entry.first << " " << entry.second << "\n";
+    std::cerr << "Folded stacks written: " << foldedFile << "\n";
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include "DebugInfo.hpp"
+#include "SimulatorIO.hpp"
+
+// Simulador da máquina hipotética: memória de 216 palavras, ACC e PC.
+// No modo de perfil mantém contadores por endereço em vetores planos.
+class Simulator {
+public:
+    static const int MEMORY_SIZE = 216;
+
+    enum Opcode {
+        ADD = 1, SUB = 2, MULT = 3, DIV = 4,
+        JMP = 5, JMPN = 6, JMPP = 7, JMPZ = 8,
+        COPY = 9, LOAD = 10, STORE = 11,
+        INPUT = 12, OUTPUT = 13, STOP = 14
+    };
+
+private:
+    std::vector<int> memory;
+    int imageSize = 0;
+    std::string baseName;     // caminho do objeto sem extensão
+    DebugInfo debugInfo;      // carregado de <base>.dbg, se existir
+    bool hasDebugInfo = false;
+    int acc = 0;
+    int pc = 0;
+    unsigned long long executed = 0;
+
+    bool interactive = false;   // INPUT lido sob demanda e OUTPUT enviado a cada linha
+    bool inputPreset = false;   // valores de INPUT já fornecidos com setInput
+    InputQueue input;
+    OutputBuffer output;
+
+    bool profiling = false;
+    std::vector<unsigned long long> execCount;     // execuções por endereço de instrução
+    std::vector<unsigned long long> takenCount;    // desvios tomados
+    std::vector<unsigned long long> notTakenCount; // desvios não tomados
+    std::vector<unsigned long long> readCount;     // leituras de dados por endereço
+    std::vector<unsigned long long> writeCount;    // escritas de dados por endereço
+
+    int readWord(int address);
+    void writeWord(int address, int value);
+    int operand(int offset) const;
+    void branch(bool taken, int target);
+    std::string describe(int address) const;
+    void execute();
+
+public:
+    explicit Simulator(bool profiling = false);
+
+    static int instructionSize(int opcode);
+
+    void load(const std::string& objectFile);
+    void setInteractive(bool enabled) { interactive = enabled; }
+    // entrada em memória: run() não lê do stream de entrada
+    void setInput(std::vector<int> values);
+    // no modo em lote lê toda a entrada antes de executar; a saída vai para out
+    // em blocos grandes e sempre é enviada no STOP ou antes de um erro
+    void run(std::istream& in, std::ostream& out);
+
+    // gera <base>.prof (hot spots) e <base>.folded (flamegraph) usando
+    // <base>.dbg e <base>.pre, quando existirem
+    void writeProfile() const;
+};
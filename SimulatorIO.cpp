@@ -0,0 +1,75 @@
+#include "SimulatorIO.hpp"
+#include <cctype>
+#include <charconv>
+#include <iterator>
+
+void InputQueue::load(std::istream& in) {
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    load(text);
+}
+
+void InputQueue::load(const std::string& text) {
+    values.clear();
+    next = 0;
+    interactive = nullptr;
+
+    const char* pos = text.data();
+    const char* end = pos + text.size();
+    while (true) {
+        while (pos < end && std::isspace(static_cast<unsigned char>(*pos))) ++pos;
+        if (pos == end) return;
+
+        // from_chars não aceita '+', que operator>> aceita
+        const char* digits = pos;
+        if (*digits == '+' && digits + 1 < end && *(digits + 1) != '-') ++digits;
+        int value;
+        auto result = std::from_chars(digits, end, value);
+        if (result.ec != std::errc()) return;
+        values.push_back(value);
+
+        // "12abc": operator>> leria 12 e falharia no próximo valor
+        pos = result.ptr;
+        if (pos < end && !std::isspace(static_cast<unsigned char>(*pos))) return;
+    }
+}
+
+void InputQueue::setValues(std::vector<int> input) {
+    values = std::move(input);
+    next = 0;
+    interactive = nullptr;
+}
+
+void InputQueue::setInteractive(std::istream& in) {
+    values.clear();
+    next = 0;
+    interactive = &in;
+}
+
+bool InputQueue::read(int& value) {
+    if (interactive) return static_cast<bool>(*interactive >> value);
+    if (next == values.size()) return false;
+    value = values[next++];
+    return true;
+}
+
+void OutputBuffer::open(std::ostream& stream, bool interactive) {
+    out = &stream;
+    lineBuffered = interactive;
+    buffer.clear();
+    if (!lineBuffered) buffer.reserve(FLUSH_SIZE + 16);
+}
+
+void OutputBuffer::write(int value) {
+    char digits[16];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr);
+    buffer.push_back('\n');
+    if (lineBuffered || buffer.size() >= FLUSH_SIZE) flush();
+}
+
+void OutputBuffer::flush() {
+    if (!out) return;
+    out->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out->flush();
+    buffer.clear();
+}
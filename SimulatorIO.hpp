@@ -0,0 +1,42 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Entrada das instruções INPUT. No modo em lote todo o texto é lido de uma
+// vez e convertido com from_chars; no modo interativo cada valor é lido do
+// stream só quando o programa executa INPUT.
+class InputQueue {
+private:
+    std::vector<int> values;
+    size_t next = 0;
+    std::istream* interactive = nullptr;
+
+public:
+    // lê e converte todo o stream; para no primeiro token inválido, como operator>>
+    void load(std::istream& in);
+    void load(const std::string& text);
+    // valores já convertidos (testes, servidor, ...)
+    void setValues(std::vector<int> input);
+    void setInteractive(std::istream& in);
+
+    bool read(int& value);
+};
+
+// Saída das instruções OUTPUT, acumulada num buffer e enviada em blocos
+// grandes, no STOP ou em caso de erro. No modo interativo cada valor é
+// enviado (e o stream esvaziado) assim que é escrito.
+class OutputBuffer {
+private:
+    static const size_t FLUSH_SIZE = 1 << 16;
+
+    std::string buffer;
+    std::ostream* out = nullptr;
+    bool lineBuffered = false;
+
+public:
+    void open(std::ostream& stream, bool interactive);
+    void write(int value);
+    void flush();
+};
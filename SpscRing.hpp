@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Fila circular limitada e sem travas para exatamente um produtor e um
+// consumidor. tail só é escrito pelo produtor e head só pelo consumidor; cada
+// lado lê o índice do outro com acquire e publica o seu com release, então o
+// conteúdo da posição fica visível antes do índice que a libera.
+template <typename T>
+class SpscRing {
+private:
+    std::vector<T> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) std::atomic<bool> closed{false};
+
+public:
+    // capacidade arredondada para a próxima potência de 2
+    explicit SpscRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // produtor; false se a fila está cheia (value não é alterado)
+    bool tryPush(T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == slots.size()) return false;
+        slots[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumidor; false se a fila está vazia
+    bool tryPop(T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        value = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // produtor: não haverá mais itens (os já enfileirados continuam disponíveis)
+    void close() { closed.store(true, std::memory_order_release); }
+    bool isClosed() const { return closed.load(std::memory_order_acquire); }
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using SymbolId = std::uint32_t;
+
+// Tabela de identificadores internados (rótulos, nomes e argumentos de macro).
+// Cada identificador distinto é copiado uma única vez para uma arena de blocos
+// fixos e recebe um id de 32 bits; comparações entre símbolos viram
+// comparações de inteiros. As views retornadas por name() continuam válidas
+// até clear(), pois os blocos da arena nunca são realocados.
+//
+// Não é sincronizada: o pré-processador e o montador de um mesmo job (ou de
+// uma mesma thread do servidor) compartilham uma instância, mas etapas em
+// threads diferentes (Pipeline) precisam de instâncias separadas.
+class SymbolPool {
+public:
+    static const SymbolId NONE = 0xFFFFFFFFu;
+
+private:
+    static const size_t BLOCK_SIZE = 16 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::vector<size_t> blockSizes;
+    size_t currentBlock = 0;   // bloco em uso
+    size_t blockUsed = 0;      // bytes ocupados no bloco em uso
+    size_t storedBytes = 0;
+
+    std::vector<std::string_view> names;                    // id -> texto na arena
+    std::unordered_map<std::string_view, SymbolId> index;   // texto na arena -> id
+
+    const char* store(std::string_view text) {
+        // procura espaço a partir do bloco atual; blocos de clear() são reaproveitados
+        while (currentBlock < blocks.size() && blockUsed + text.size() > blockSizes[currentBlock]) {
+            ++currentBlock;
+            blockUsed = 0;
+        }
+        if (currentBlock == blocks.size()) {
+            size_t size = text.size() > BLOCK_SIZE ? text.size() : BLOCK_SIZE;
+            blocks.emplace_back(new char[size]);
+            blockSizes.push_back(size);
+            blockUsed = 0;
+        }
+        char* dest = blocks[currentBlock].get() + blockUsed;
+        if (!text.empty()) std::memcpy(dest, text.data(), text.size());
+        blockUsed += text.size();
+        storedBytes += text.size();
+        return dest;
+    }
+
+public:
+    SymbolPool() = default;
+    SymbolPool(const SymbolPool&) = delete;
+    SymbolPool& operator=(const SymbolPool&) = delete;
+
+    // id do texto, inserindo-o na primeira ocorrência
+    SymbolId intern(std::string_view text) {
+        auto it = index.find(text);
+        if (it != index.end()) return it->second;
+
+        std::string_view stored(store(text), text.size());
+        SymbolId id = static_cast<SymbolId>(names.size());
+        names.push_back(stored);
+        index.emplace(stored, id);
+        return id;
+    }
+
+    // id do texto, ou NONE se ainda não foi internado (não altera a tabela)
+    SymbolId find(std::string_view text) const {
+        auto it = index.find(text);
+        return it == index.end() ? NONE : it->second;
+    }
+
+    std::string_view name(SymbolId id) const { return names[id]; }
+    std::string str(SymbolId id) const { return std::string(names[id]); }
+
+    size_t size() const { return names.size(); }
+    size_t bytes() const { return storedBytes; }
+
+    // esquece todos os símbolos; os blocos já alocados são mantidos para reuso
+    void clear() {
+        names.clear();
+        index.clear();
+        currentBlock = 0;
+        blockUsed = 0;
+        storedBytes = 0;
+    }
+};
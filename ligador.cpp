@@ -0,0 +1,37 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Linker.hpp"
+
+
+int main(int argc, char** argv) {
+    std::string output;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) output = argv[++i];
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [-o <file.o2>] <mod1.obj> [mod2.obj ...]\n";
+        return 1;
+    }
+    if (output.empty()) {
+        // nome do primeiro módulo com extensão .o2
+        output = inputs[0];
+        size_t dot = output.find_last_of('.');
+        size_t slash = output.find_last_of("/\\");
+        if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) output = output.substr(0, dot);
+        output += ".o2";
+    }
+    try {
+        Linker linker;
+        linker.load(inputs);
+        linker.link();
+        linker.write(output);
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include "Preprocessor.hpp"
+#include "Assembler.hpp"
+#include "Pipeline.hpp"
+
+using namespace std;
+
+// ============================================================================
+// FUNÇÃO PRINCIPAL
+// ============================================================================
+
+// Pré-processa e monta o .asm sem o .pre intermediário: leitura, Preprocessor
+// e Assembler em pipeline. Gera os mesmos arquivos que preprocessor seguido
+// de compilador.
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        cerr << "Erro: Forneca um nome de arquivo como argumento.\n";
+        cerr << "Uso: " << argv[0] << " arquivo.asm [all|o1|o2|obj] [-O] [-Od] [-k] [-a] [-s] [-v]\n";
+        return 1;
+    }
+
+    try {
+        // Cada etapa usa a própria SymbolPool (a de cada instância): no
+        // pipeline elas rodam em threads diferentes e a tabela não é sincronizada
+        Preprocessor preprocessor;
+        Assembler assembler;
+
+        bool serial = false;
+        bool showStats = false;
+        for (int i = 3; i < argc; i++) {
+            string flag = argv[i];
+            if (flag == "-O") assembler.setOptimization(true);
+            else if (flag == "-Od") assembler.setDataOptimization(true);
+            else if (flag == "-k") {
+                preprocessor.setDiagnosticsMode(true);
+                assembler.setDiagnosticsMode(true);
+            }
+            else if (flag == "-a") assembler.setFlowAnalysis(true);
+            else if (flag == "-s") serial = true;
+            else if (flag == "-v") showStats = true;
+            else {
+                cerr << "Opcao desconhecida: " << flag << "\n";
+                return 1;
+            }
+        }
+
+        string input = argv[1];
+        ifstream file(input, ios::binary);
+        if (!file.is_open()) {
+            throw runtime_error("Nao foi possivel abrir o arquivo '" + input + "'");
+        }
+        size_t slash = input.find_last_of('/');
+        preprocessor.setIncludeDir(slash == string::npos ? "" : input.substr(0, slash));
+
+        Pipeline pipeline(preprocessor, assembler);
+        if (serial) pipeline.runSerial(file);
+        else pipeline.run(file);
+        if (showStats) cerr << pipeline.formatStats();
+
+        // Modo de diagnóstico: erros do Preprocessor primeiro; com eles o
+        // programa não chega a ser montado
+        const auto& preDiagnostics = preprocessor.getDiagnostics();
+        if (!preDiagnostics.empty()) {
+            for (const auto& d : preDiagnostics) {
+                cerr << "Linha " << d.line << ": " << d.message << "\n";
+            }
+            cerr << preDiagnostics.size() << " erro(s) encontrado(s).\n";
+            return 1;
+        }
+        const auto& diagnostics = assembler.getDiagnostics();
+        if (!diagnostics.empty()) {
+            for (const auto& d : diagnostics) {
+                cerr << d.message << "\n";
+            }
+            cerr << diagnostics.size() << " erro(s) encontrado(s).\n";
+            return 1;
+        }
+
+        assembler.generateOutputFiles(input, argv[2]);
+    } catch (const runtime_error& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,20 +1,49 @@
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <thread>
 #include "Preprocessor.hpp"
 
 
 int main(int argc, char** argv) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <file.asm>\n";
+    std::string input;
+    bool trackLines = false;
+    bool keepGoing = false;
+    unsigned threads = 1;
+    bool validArgs = argc >= 2;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-g") trackLines = true;
+        else if (arg == "-k") keepGoing = true;
+        else if (arg == "-j") threads = std::max(1u, std::thread::hardware_concurrency());
+        else if (arg.rfind("-j", 0) == 0 && arg.size() <= 5 && arg.find_first_not_of("0123456789", 2) == std::string::npos)
+            threads = static_cast<unsigned>(std::stoul(arg.substr(2)));
+        else if (input.empty()) input = arg;
+        else validArgs = false;
+    }
+    if (!validArgs || input.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <file.asm> [-g] [-k] [-j[N]]\n";
         return 1;
     }
-    std::string input = argv[1];
     try {
         Preprocessor pp;
+        pp.setLineTracking(trackLines);
+        pp.setDiagnosticsMode(keepGoing);
+        pp.setThreads(threads);
         pp.process(input);
+
+        // modo de diagnóstico: todos os erros de uma vez
+        const auto& diagnostics = pp.getDiagnostics();
+        if (!diagnostics.empty()) {
+            for (const auto& d : diagnostics) {
+                std::cerr << "Line " << d.line << ": " << d.message << "\n";
+            }
+            std::cerr << diagnostics.size() << " error(s) found.\n";
+            return 2;
+        }
     } catch (const std::exception& ex) {
         std::cerr << "Error: " << ex.what() << "\n";
         return 2;
     }
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,35 @@
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "Server.hpp"
+
+
+int main(int argc, char** argv) {
+    unsigned workers = std::thread::hardware_concurrency();
+    std::string socketPath;
+    std::string includeDir;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) workers = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (arg == "-s" && i + 1 < argc) socketPath = argv[++i];
+        else if (arg == "-I" && i + 1 < argc) includeDir = argv[++i];
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-j <threads>] [-s <socket>] [-I <include dir>]\n";
+            return 1;
+        }
+    }
+
+    // cliente que desconecta no meio de uma resposta não derruba o servidor
+    std::signal(SIGPIPE, SIG_IGN);
+
+    try {
+        Server server(workers, includeDir);
+        if (socketPath.empty()) server.serveStdio();
+        else server.serveSocket(socketPath);
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include "Simulator.hpp"
+
+
+int main(int argc, char** argv) {
+    std::string input;
+    std::string inputFile;
+    bool profiling = false;
+    bool interactive = false;
+    bool validArgs = argc >= 2;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-p") profiling = true;
+        else if (arg == "-t") interactive = true;
+        else if (arg == "-i" && i + 1 < argc) inputFile = argv[++i];
+        else if (input.empty()) input = arg;
+        else validArgs = false;
+    }
+    if (!validArgs || input.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <file.o2> [-p] [-i input.txt] [-t]\n";
+        return 1;
+    }
+    try {
+        std::ifstream fin;
+        if (!inputFile.empty()) {
+            fin.open(inputFile);
+            if (!fin.is_open()) throw std::runtime_error("Unable to open input file: " + inputFile);
+        }
+
+        // entrada pelo terminal: cada INPUT é lido na hora e cada OUTPUT aparece na hora
+        if (inputFile.empty() && isatty(STDIN_FILENO)) interactive = true;
+
+        Simulator sim(profiling);
+        sim.load(input);
+        sim.setInteractive(interactive);
+        sim.run(inputFile.empty() ? std::cin : fin, std::cout);
+        if (profiling) sim.writeProfile();
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
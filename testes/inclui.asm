@@ -0,0 +1,20 @@
+INCLUDE biblioteca.mac ; bibliotecas nao contam no limite
+SQR: MACRO &N
+LOAD &N
+MULT &N
+STORE &N
+ENDMACRO
+TRIPLE: MACRO &N
+DUP &N
+INC &N
+ENDMACRO
+INPUT X
+SWAP X, Y
+TRIPLE X
+SQR Y
+OUTPUT X
+STOP
+X: SPACE
+Y: CONST 3
+TMP: SPACE
+ONE: CONST 1
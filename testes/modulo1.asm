@@ -0,0 +1,13 @@
+; Módulo principal: lê dois valores e usa a rotina SOMA do modulo2
+SOMA:   EXTERN
+RESULT: EXTERN
+        PUBLIC A
+        PUBLIC B
+        PUBLIC VOLTA
+        INPUT A
+        INPUT B
+        JMP SOMA
+VOLTA:  OUTPUT RESULT
+        STOP
+A:      SPACE
+B:      SPACE
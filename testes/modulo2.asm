@@ -0,0 +1,11 @@
+; Módulo com a rotina SOMA: RESULT = A + B, depois volta para VOLTA
+A:      EXTERN
+B:      EXTERN
+VOLTA:  EXTERN
+        PUBLIC SOMA
+        PUBLIC RESULT
+SOMA:   LOAD A
+        ADD B
+        STORE RESULT
+        JMP VOLTA
+RESULT: SPACE